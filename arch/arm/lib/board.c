@@ -45,6 +45,7 @@
 #include <timestamp.h>
 #include <version.h>
 #include <net.h>
+#include <bootstage.h>
 #include <serial.h>
 #include <nand.h>
 #include <onenand_uboot.h>
@@ -294,6 +295,7 @@ void start_armboot (void)
 			hang ();
 		}
 	}
+	bootstage_mark("init_sequence");
 
 	/* armboot_start is defined in the board-specific linker script */
 	mem_malloc_init (_armboot_start - CONFIG_SYS_MALLOC_LEN,
@@ -432,11 +434,14 @@ extern void davinci_eth_set_mac_addr (const u_int8_t *addr);
 	puts ("Net:   ");
 #endif
 	eth_initialize(gd->bd);
+	bootstage_mark("eth_initialize");
 #if defined(CONFIG_RESET_PHY_R)
 	debug ("Reset Ethernet PHY\n");
 	reset_phy();
 #endif
 #endif
+	bootstage_mark("main_loop");
+
 	/* main_loop() can return to retry autoboot, if so just run it again. */
 	for (;;) {
 		main_loop ();
@@ -26,6 +26,7 @@
 #include <command.h>
 #include <malloc.h>
 #include <stdio_dev.h>
+#include <bootstage.h>
 #ifdef CONFIG_8xx
 #include <mpc8xx.h>
 #endif
@@ -640,6 +641,7 @@ void board_init_r (gd_t *id, ulong dest_addr)
 	bd = gd->bd;
 
 	gd->flags |= GD_FLG_RELOC;	/* tell others: relocation done */
+	bootstage_mark("board_init_r");
 
 	/* The Malloc area is immediately below the monitor copy in DRAM */
 	malloc_start = dest_addr - TOTAL_MALLOC_LEN;
@@ -960,6 +962,7 @@ void board_init_r (gd_t *id, ulong dest_addr)
 	puts ("Net:   ");
 #endif
 	eth_initialize (bd);
+	bootstage_mark("eth_initialize");
 #endif
 
 #if defined(CONFIG_CMD_NET) && defined(CONFIG_RESET_PHY_R)
@@ -1052,6 +1055,7 @@ void board_init_r (gd_t *id, ulong dest_addr)
 #endif
 
 	/* Initialization complete - start the monitor */
+	bootstage_mark("main_loop");
 
 	/* main_loop() can return to retry autoboot, if so just run it again. */
 	for (;;) {
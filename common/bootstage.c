@@ -0,0 +1,157 @@
+/*
+ * (C) Copyright 2010
+ * The U-Boot Authors
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Boot time recorder, see include/bootstage.h
+ *
+ * Marks are only taken once the monitor runs from RAM; before that
+ * the data section may still be in flash.  The timebase keeps
+ * running from reset on most CPUs, so the first recorded time also
+ * shows how long the early code took.
+ */
+
+#include <common.h>
+#include <bootstage.h>
+#include <div64.h>
+#ifdef CONFIG_BOOTSTAGE_FDT
+#include <libfdt.h>
+#endif
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#ifndef CONFIG_BOOTSTAGE_RECORD_COUNT
+#define CONFIG_BOOTSTAGE_RECORD_COUNT	32
+#endif
+
+struct bootstage_record {
+	unsigned long long	ticks;
+	const char		*name;
+};
+
+static struct bootstage_record record[CONFIG_BOOTSTAGE_RECORD_COUNT];
+static unsigned int record_count;	/* marks taken, including lost ones */
+
+void bootstage_mark(const char *name)
+{
+	struct bootstage_record *rec;
+
+	if (!(gd->flags & GD_FLG_RELOC))
+		return;
+
+	rec = &record[record_count++ % CONFIG_BOOTSTAGE_RECORD_COUNT];
+	rec->ticks = get_ticks();
+	rec->name = name;
+}
+
+/* convert timebase ticks to microseconds */
+static ulong bootstage_ticks_to_us(unsigned long long ticks)
+{
+	ulong khz = get_tbclk() / 1000;
+
+	if (khz == 0)
+		khz = 1;
+	return lldiv(ticks * 1000, khz);
+}
+
+/* index of the oldest record still in the ring, and number of records */
+static unsigned int bootstage_first(unsigned int *count)
+{
+	if (record_count <= CONFIG_BOOTSTAGE_RECORD_COUNT) {
+		*count = record_count;
+		return 0;
+	}
+	*count = CONFIG_BOOTSTAGE_RECORD_COUNT;
+	return record_count % CONFIG_BOOTSTAGE_RECORD_COUNT;
+}
+
+void bootstage_report(void)
+{
+	struct bootstage_record *rec;
+	unsigned int i, first, count;
+	ulong us, prev = 0;
+
+	first = bootstage_first(&count);
+	if (record_count > count)
+		printf("(%u earlier records lost)\n", record_count - count);
+
+	puts("Timer summary in microseconds:\n");
+	printf("%11s%11s  %s\n", "Mark", "Elapsed", "Stage");
+	for (i = 0; i < count; i++) {
+		rec = &record[(first + i) % CONFIG_BOOTSTAGE_RECORD_COUNT];
+		us = bootstage_ticks_to_us(rec->ticks);
+		printf("%11lu%11lu  %s\n", us, i ? us - prev : 0, rec->name);
+		prev = us;
+	}
+}
+
+#ifdef CONFIG_BOOTSTAGE_FDT
+/*
+ * Add the records to the device tree as
+ *
+ *	bootstage {
+ *		0 { name = "..."; mark = <microseconds>; };
+ *		1 { ... };
+ *	};
+ */
+int bootstage_fdt_add(void *blob)
+{
+	struct bootstage_record *rec;
+	unsigned int i, first, count;
+	char node_name[12];
+	int bootstage, node, err;
+
+	bootstage_mark("fdt_fixup");
+
+	bootstage = fdt_path_offset(blob, "/bootstage");
+	if (bootstage >= 0)
+		fdt_del_node(blob, bootstage);
+	bootstage = fdt_add_subnode(blob, 0, "bootstage");
+	if (bootstage < 0)
+		goto err;
+
+	first = bootstage_first(&count);
+	for (i = 0; i < count; i++) {
+		rec = &record[(first + i) % CONFIG_BOOTSTAGE_RECORD_COUNT];
+		sprintf(node_name, "%u", i);
+		node = fdt_add_subnode(blob, bootstage, node_name);
+		if (node < 0) {
+			bootstage = node;
+			goto err;
+		}
+		err = fdt_setprop_string(blob, node, "name", rec->name);
+		if (!err)
+			err = fdt_setprop_cell(blob, node, "mark",
+					bootstage_ticks_to_us(rec->ticks));
+		if (err) {
+			bootstage = err;
+			goto err;
+		}
+	}
+	return 0;
+
+err:
+	printf("WARNING: could not add /bootstage %s.\n",
+		fdt_strerror(bootstage));
+	return bootstage;
+}
+#endif /* CONFIG_BOOTSTAGE_FDT */
@@ -0,0 +1,70 @@
+/*
+ * (C) Copyright 2010
+ * The U-Boot Authors
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+
+/*
+ * Block device read cache command
+ */
+
+#include <common.h>
+#include <command.h>
+#include <part.h>
+
+int do_blkcache(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	struct blkcache_stats s;
+
+	if (argc > 2) {
+		cmd_usage(cmdtp);
+		return 1;
+	}
+
+	if (argc == 2) {
+		if (strcmp(argv[1], "clear") == 0) {
+			blkcache_invalidate(NULL);
+			blkcache_reset_stats();
+			return 0;
+		}
+		if (strcmp(argv[1], "show") != 0) {
+			cmd_usage(cmdtp);
+			return 1;
+		}
+	}
+
+	blkcache_get_stats(&s);
+	printf("entries:   %lu used / %lu, %lu blocks each\n",
+		s.used, s.entries, s.readahead);
+	printf("hits:      %lu\n", s.hits);
+	printf("misses:    %lu\n", s.misses);
+	printf("bypassed:  %lu\n", s.bypass);
+	return 0;
+}
+
+U_BOOT_CMD(
+	blkcache,	2,	1,	do_blkcache,
+	"block device read cache",
+	"[show]\n"
+	"    - print cache hit/miss statistics\n"
+	"blkcache clear\n"
+	"    - drop all cached blocks and reset the statistics"
+);
@@ -30,6 +30,7 @@
 #include <command.h>
 #include <image.h>
 #include <malloc.h>
+#include <bootstage.h>
 #include <u-boot/zlib.h>
 #include <bzlib.h>
 #include <environment.h>
@@ -63,10 +64,6 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
-#ifndef CONFIG_SYS_BOOTM_LEN
-#define CONFIG_SYS_BOOTM_LEN	0x800000	/* use 8MByte as default max gunzip size */
-#endif
-
 #ifdef CONFIG_BZIP2
 extern void bz_internal_error(int);
 #endif
@@ -342,8 +339,10 @@ static int bootm_load_os(image_info_t os, ulong *load_end, int boot_progress)
 			printf ("   XIP %s ... ", type_name);
 		} else {
 			printf ("   Loading %s ... ", type_name);
-			memmove_wd ((void *)load, (void *)image_start,
-					image_len, CHUNKSZ);
+			/* already in place e.g. if unpacked while loading */
+			if (load != image_start)
+				memmove_wd ((void *)load, (void *)image_start,
+						image_len, CHUNKSZ);
 		}
 		*load_end = load + image_len;
 		puts("OK\n");
@@ -612,6 +611,8 @@ int do_bootm (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 			return do_bootm_subcommand(cmdtp, flag, argc, argv);
 	}
 
+	bootstage_mark("bootm_start");
+
 	if (bootm_start(cmdtp, flag, argc, argv))
 		return 1;
 
@@ -670,6 +671,7 @@ int do_bootm (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 	}
 
 	lmb_reserve(&images.lmb, images.os.load, (load_end - images.os.load));
+	bootstage_mark("bootm_loaded");
 
 	if (images.os.type == IH_TYPE_STANDALONE) {
 		if (iflag)
@@ -699,6 +701,11 @@ int do_bootm (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 
 	arch_preboot_os();
 
+	bootstage_mark("boot_os");
+#ifdef CONFIG_BOOTSTAGE_REPORT
+	bootstage_report();
+#endif
+
 	boot_fn(0, argc, argv, &images);
 
 	show_boot_progress (-9);
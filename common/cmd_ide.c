@@ -337,6 +337,7 @@ int do_ide (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 			curr_device, blk, cnt);
 #endif
 
+		blkcache_invalidate (&ide_dev_desc[curr_device]);
 		n = ide_write (curr_device, blk, cnt, (ulong *)addr);
 
 		printf ("%ld blocks written: %s\n",
@@ -600,6 +601,8 @@ void ide_init (void)
 
 	WATCHDOG_RESET();
 
+	blkcache_invalidate (NULL);
+
 #ifdef CONFIG_IDE_8xx_DIRECT
 	/* Initialize PIO timing tables */
 	for (i=0; i <= IDE_MAX_PIO_MODE; ++i) {
@@ -33,6 +33,7 @@
 #include <dataflash.h>
 #endif
 #include <watchdog.h>
+#include <memtest.h>
 
 #include <u-boot/md5.h>
 #include <sha1.h>
@@ -621,21 +622,39 @@ int do_mem_loopw (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 }
 #endif /* CONFIG_LOOPW */
 
+#if defined(CONFIG_SYS_FAST_MEMTEST)
+static void mtest_report (const char *test, ulong addr,
+			  u64 expected, u64 actual)
+{
+	printf ("\nFAILURE (%s) @ 0x%08lx: "
+		"expected 0x%08x%08x, actual 0x%08x%08x\n",
+		test, addr, (uint)(expected >> 32), (uint)expected,
+		(uint)(actual >> 32), (uint)actual);
+}
+#endif
+
 /*
  * Perform a memory test. A more complete alternative test can be
- * configured using CONFIG_SYS_ALT_MEMTEST. The complete test loops until
+ * configured using CONFIG_SYS_ALT_MEMTEST, a faster one using
+ * CONFIG_SYS_FAST_MEMTEST. The complete test loops until
  * interrupted by ctrl-c or by a failure of one of the sub-tests.
  */
 int do_mem_mtest (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 {
-	vu_long	*addr, *start, *end;
+	vu_long	*start, *end;
+#if !defined(CONFIG_SYS_FAST_MEMTEST)
+	vu_long	*addr;
 	ulong	val;
 	ulong	readback;
+#endif
 	ulong	errs = 0;
 	int iterations = 1;
 	int iteration_limit;
 
-#if defined(CONFIG_SYS_ALT_MEMTEST)
+#if defined(CONFIG_SYS_FAST_MEMTEST)
+	ulong	pattern;
+	long	ret;
+#elif defined(CONFIG_SYS_ALT_MEMTEST)
 	vu_long	len;
 	vu_long	offset;
 	vu_long	test_offset;
@@ -685,7 +704,30 @@ int do_mem_mtest (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 	else
 		iteration_limit = 0;
 
-#if defined(CONFIG_SYS_ALT_MEMTEST)
+#if defined(CONFIG_SYS_FAST_MEMTEST)
+	printf ("Testing %08x ... %08x:\n", (uint)start, (uint)end);
+
+	for (;;) {
+		if (iteration_limit && iterations > iteration_limit) {
+			printf("Tested %d iteration(s) with %lu errors.\n",
+				iterations-1, errs);
+			return errs != 0;
+		}
+
+		printf("Iteration: %6d\n", iterations);
+		iterations++;
+
+		ret = memtest_run ((ulong)start, (ulong)end - (ulong)start,
+				   MEMTEST_ALL | MEMTEST_PROGRESS | MEMTEST_CTRLC,
+				   pattern, mtest_report);
+		if (ret < 0) {
+			putc ('\n');
+			return 1;
+		}
+		errs += ret;
+	}
+
+#elif defined(CONFIG_SYS_ALT_MEMTEST)
 	printf ("Testing %08x ... %08x:\n", (uint)start, (uint)end);
 	PRINTF("%s:%d: start 0x%p end 0x%p\n",
 		__FUNCTION__, __LINE__, start, end);
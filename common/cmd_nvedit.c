@@ -53,6 +53,7 @@
 #if defined(CONFIG_CMD_NET)
 #include <net.h>
 #endif
+#include <hush.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -178,7 +179,10 @@ int _do_setenv (int flag, int argc, char *argv[])
 {
 	int   i, len, oldval;
 	int   console = -1;
-	uchar *env, *nxt = NULL;
+#ifdef CONFIG_ENV_HASH
+	int   hashed, newpos;
+#endif
+	uchar *env = NULL, *nxt = NULL;
 	char *name;
 	bd_t *bd = gd->bd;
 
@@ -195,10 +199,21 @@ int _do_setenv (int flag, int argc, char *argv[])
 	}
 
 	env_id++;
+	hush_cache_invalidate(name);
 	/*
 	 * search if variable with this name already exists
 	 */
 	oldval = -1;
+#ifdef CONFIG_ENV_HASH
+	if ((hashed = env_hash_ready()) != 0) {
+		i = env_hash_lookup(name);
+		if (i >= 0) {
+			env = env_data + i;
+			nxt = env + strlen((char *)env);
+			oldval = envmatch((uchar *)name, i);
+		}
+	} else
+#endif
 	for (env=env_data; *env; env=nxt+1) {
 		for (nxt=env; *nxt; ++nxt)
 			;
@@ -296,6 +311,10 @@ int _do_setenv (int flag, int argc, char *argv[])
 			}
 		}
 
+#ifdef CONFIG_ENV_HASH
+		if (hashed)
+			env_hash_delete(env - env_data, nxt - env + 1);
+#endif
 		if (*++nxt == '\0') {
 			if (env > env_data) {
 				env--;
@@ -313,19 +332,32 @@ int _do_setenv (int flag, int argc, char *argv[])
 		*++env = '\0';
 	}
 
+	/*
+	 * The CRC is left alone: saveenv() computes it before writing
+	 * the environment out.
+	 */
+
 	/* Delete only ? */
-	if ((argc < 3) || argv[2] == NULL) {
-		env_crc_update ();
+	if ((argc < 3) || argv[2] == NULL)
 		return 0;
-	}
 
 	/*
 	 * Append new definition at the end
 	 */
-	for (env=env_data; *env || *(env+1); ++env)
-		;
-	if (env > env_data)
-		++env;
+#ifdef CONFIG_ENV_HASH
+	if (hashed) {
+		env = env_data + env_hash_append_offset();
+	} else
+#endif
+	{
+		for (env=env_data; *env || *(env+1); ++env)
+			;
+		if (env > env_data)
+			++env;
+	}
+#ifdef CONFIG_ENV_HASH
+	newpos = env - env_data;
+#endif
 	/*
 	 * Overflow when:
 	 * "name" + "=" + "val" +"\0\0"  > ENV_SIZE - (env-env_data)
@@ -352,8 +384,10 @@ int _do_setenv (int flag, int argc, char *argv[])
 	/* end is marked with double '\0' */
 	*++env = '\0';
 
-	/* Update CRC */
-	env_crc_update ();
+#ifdef CONFIG_ENV_HASH
+	if (hashed)
+		env_hash_insert(newpos);
+#endif
 
 	/*
 	 * Some variables should be updated when the corresponding
@@ -547,6 +581,14 @@ char *getenv (char *name)
 
 	WATCHDOG_RESET();
 
+#ifdef CONFIG_ENV_HASH
+	if (env_hash_ready()) {
+		if ((i = env_hash_lookup(name)) < 0)
+			return (NULL);
+		return ((char *)env_get_addr(envmatch((uchar *)name, i)));
+	}
+#endif
+
 	for (i=0; env_get_char(i) != '\0'; i=nxt+1) {
 		int val;
 
@@ -567,6 +609,23 @@ int getenv_r (char *name, char *buf, unsigned len)
 {
 	int i, nxt;
 
+#ifdef CONFIG_ENV_HASH
+	if (env_hash_ready()) {
+		int val, n;
+
+		if ((i = env_hash_lookup(name)) < 0)
+			return (-1);
+		val = envmatch((uchar *)name, i);
+		/* found; copy out */
+		n = 0;
+		while ((len > n++) && (*buf++ = env_get_char(val++)) != '\0')
+			;
+		if (len == n)
+			*buf = '\0';
+		return (n);
+	}
+#endif
+
 	for (i=0; env_get_char(i) != '\0'; i=nxt+1) {
 		int val, n;
 
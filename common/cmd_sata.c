@@ -66,8 +66,12 @@ int do_sata(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 {
 	int rc = 0;
 
-	if (argc == 2 && strcmp(argv[1], "init") == 0)
+	if (argc == 2 && strcmp(argv[1], "init") == 0) {
+		/* the devices may have been swapped */
+		for (rc = 0; rc < CONFIG_SYS_SATA_MAX_DEVICE; rc++)
+			blkcache_invalidate(&sata_dev_desc[rc]);
 		return sata_initialize();
+	}
 
 	/* If the user has not yet run `sata init`, do it now */
 	if (sata_curr_device == -1)
@@ -178,6 +182,7 @@ int do_sata(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 			printf("\nSATA write: device %d block # %ld, count %ld ... ",
 				sata_curr_device, blk, cnt);
 
+			blkcache_invalidate(&sata_dev_desc[sata_curr_device]);
 			n = sata_write(sata_curr_device, blk, cnt, (u32 *)addr);
 
 			printf("%ld blocks written: %s\n",
@@ -88,6 +88,7 @@ void scsi_scan(int mode)
 	if(mode==1) {
 		printf("scanning bus for devices...\n");
 	}
+	blkcache_invalidate(NULL);
 	for(i=0;i<CONFIG_SYS_SCSI_MAX_DEVICE;i++) {
 		scsi_dev_desc[i].target=0xff;
 		scsi_dev_desc[i].lun=0xff;
@@ -663,6 +663,7 @@ int do_usb(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 			printf("\nUSB write: device %d block # %ld, count %ld"
 				" ... ", usb_stor_curr_dev, blk, cnt);
 			stor_dev = usb_stor_get_dev(usb_stor_curr_dev);
+			blkcache_invalidate(stor_dev);
 			n = stor_dev->block_write(usb_stor_curr_dev, blk, cnt,
 						(ulong *)addr);
 			printf("%ld blocks write: %s\n", n,
@@ -27,6 +27,73 @@
 
 #include <common.h>
 #include <command.h>
+#ifdef CONFIG_SYS_CMD_INDEX
+#include <malloc.h>
+#endif
+
+#ifdef CONFIG_SYS_CMD_INDEX
+/***************************************************************************
+ * Index of the command table, sorted by name
+ *
+ * Commands sharing a prefix are adjacent in the index, so both exact
+ * and abbreviated lookups are a binary search followed by a look at
+ * the next entry.  The index is built by cmd_index_init() once the
+ * command table has been relocated and malloc() works; until then
+ * the table is searched linearly.
+ */
+static cmd_tbl_t **cmd_index;
+static int cmd_index_len;
+
+void cmd_index_init(void)
+{
+	int n = &__u_boot_cmd_end - &__u_boot_cmd_start;
+	cmd_tbl_t **idx;
+	int i, lo, hi, mid;
+
+	if (cmd_index != NULL)
+		return;
+
+	idx = malloc(n * sizeof(*idx));
+	if (idx == NULL)
+		return;
+
+	/* binary insertion sort, stable so duplicates keep table order */
+	for (i = 0; i < n; i++) {
+		cmd_tbl_t *cmdtp = &__u_boot_cmd_start + i;
+
+		for (lo = 0, hi = i; lo < hi; ) {
+			mid = (lo + hi) / 2;
+			if (strcmp(idx[mid]->name, cmdtp->name) <= 0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		memmove(&idx[lo + 1], &idx[lo], (i - lo) * sizeof(*idx));
+		idx[lo] = cmdtp;
+	}
+
+	cmd_index_len = n;
+	cmd_index = idx;
+}
+
+/*
+ * Return the position of the first index entry whose name is not
+ * sorted before the first "len" characters of "cmd".
+ */
+static int cmd_index_find(const char *cmd, int len)
+{
+	int lo = 0, hi = cmd_index_len, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (strncmp(cmd_index[mid]->name, cmd, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+#endif /* CONFIG_SYS_CMD_INDEX */
 
 /*
  * Use puts() instead of printf() to avoid printf buffer overflow
@@ -49,6 +116,12 @@ int _do_help (cmd_tbl_t *cmd_start, int cmd_items, cmd_tbl_t * cmdtp, int
 			cmd_array[i] = cmdtp++;
 		}
 
+#ifdef CONFIG_SYS_CMD_INDEX
+		/* The main command table is already sorted in the index */
+		if (cmd_index != NULL && cmd_start == &__u_boot_cmd_start)
+			memcpy(cmd_array, cmd_index, sizeof(cmd_array));
+		else
+#endif
 		/* Sort command list (trivial bubble sort) */
 		for (i = cmd_items - 1; i > 0; --i) {
 			swaps = 0;
@@ -132,9 +205,34 @@ cmd_tbl_t *find_cmd_tbl (const char *cmd, cmd_tbl_t *table, int table_len)
 	return NULL;	/* not found or ambiguous command */
 }
 
+
 cmd_tbl_t *find_cmd (const char *cmd)
 {
 	int len = &__u_boot_cmd_end - &__u_boot_cmd_start;
+
+#ifdef CONFIG_SYS_CMD_INDEX
+	if (cmd_index != NULL) {
+		const char *p;
+		cmd_tbl_t *cmdtp;
+		int i;
+
+		/* compare command name only until first dot, see above */
+		len = ((p = strchr(cmd, '.')) == NULL) ? strlen (cmd) : (p - cmd);
+
+		i = cmd_index_find(cmd, len);
+		if (i == cmd_index_len)
+			return NULL;
+		cmdtp = cmd_index[i];
+		if (strncmp(cmd, cmdtp->name, len) != 0)
+			return NULL;		/* not found */
+		if (cmdtp->name[len] == '\0')
+			return cmdtp;		/* full match sorts first */
+		if (i + 1 < cmd_index_len &&
+		    strncmp(cmd, cmd_index[i + 1]->name, len) == 0)
+			return NULL;		/* ambiguous command */
+		return cmdtp;			/* unique abbreviation */
+	}
+#endif
 	return find_cmd_tbl(cmd, &__u_boot_cmd_start, len);
 }
 
@@ -248,6 +346,30 @@ static int complete_cmdv(int argc, char *argv[], char last_char, int maxv, char
 	else
 		len = p - cmd;
 
+#ifdef CONFIG_SYS_CMD_INDEX
+	if (cmd_index != NULL) {
+		int i;
+
+		/* the partial matches are adjacent in the index */
+		for (i = cmd_index_find(cmd, len); i < cmd_index_len; i++) {
+			cmdtp = cmd_index[i];
+			if (strncmp(cmd, cmdtp->name, len) != 0)
+				break;
+
+			/* too many! */
+			if (n_found >= maxv - 2) {
+				cmdv[n_found++] = "...";
+				break;
+			}
+
+			cmdv[n_found++] = cmdtp->name;
+		}
+
+		cmdv[n_found] = NULL;
+		return n_found;
+	}
+#endif
+
 	/* return the partial matches */
 	for (cmdtp = &__u_boot_cmd_start; cmdtp != &__u_boot_cmd_end; cmdtp++) {
 
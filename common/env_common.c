@@ -29,6 +29,7 @@
 #include <environment.h>
 #include <linux/stddef.h>
 #include <malloc.h>
+#include <bootstage.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -220,6 +221,9 @@ void set_default_env(void)
 #endif
 	env_crc_update ();
 	gd->env_valid = 1;
+#ifdef CONFIG_ENV_HASH
+	env_hash_rebuild();
+#endif
 }
 
 void env_relocate (void)
@@ -267,7 +271,183 @@ void env_relocate (void)
 #ifdef CONFIG_AMIGAONEG3SE
 	disable_nvram();
 #endif
+#ifdef CONFIG_ENV_HASH
+	env_hash_rebuild();
+#endif
+	bootstage_mark("env_relocate");
+}
+
+#ifdef CONFIG_ENV_HASH
+/************************************************************************
+ * Hash index over the in-RAM copy of the environment
+ *
+ * The flat "name=value\0...\0\0" block stays the master copy (it is
+ * what saveenv() writes out), the index just maps variable names to
+ * the offset of their "name=value" string.  It uses open addressing
+ * with linear probing; deleted slots are marked and reclaimed on the
+ * next rebuild.  Whenever the index is unusable (before relocation,
+ * out of memory, environment moved) the callers fall back to the
+ * linear scan.
+ */
+#define ENV_HASH_EMPTY		(-1)
+#define ENV_HASH_DELETED	(-2)
+#define ENV_HASH_MIN		64
+
+static int *env_hash_tab;	/* name hash slot -> entry offset	*/
+static int env_hash_size;	/* number of slots, a power of two	*/
+static int env_hash_used;	/* slots not empty (incl. deleted)	*/
+static int env_hash_end;	/* offset where the next entry goes	*/
+static ulong env_hash_base;	/* gd->env_addr the index refers to	*/
+
+/* hash a variable name, which ends at '=' or '\0' */
+static uint env_hash_name(const uchar *s)
+{
+	uint h = 0;
+
+	while (*s != '\0' && *s != '=')
+		h = h * 31 + *s++;
+
+	return h;
+}
+
+/* compare a variable name with the name of the entry at "index" */
+static int env_hash_match(const uchar *name, int index)
+{
+	const uchar *e = (uchar *)env_hash_base + index;
+
+	while (*name != '\0' && *name != '=') {
+		if (*name++ != *e++)
+			return 0;
+	}
+	return *e == '=';
+}
+
+static void env_hash_add(int index)
+{
+	uint i = env_hash_name((uchar *)env_hash_base + index);
+
+	for (i &= env_hash_size - 1; env_hash_tab[i] >= 0;
+	     i = (i + 1) & (env_hash_size - 1))
+		;
+	if (env_hash_tab[i] == ENV_HASH_EMPTY)
+		env_hash_used++;
+	env_hash_tab[i] = index;
+}
+
+int env_hash_ready(void)
+{
+	return env_hash_tab != NULL &&
+	       (gd->flags & GD_FLG_RELOC) &&
+	       gd->env_valid &&
+	       env_hash_base == gd->env_addr;
+}
+
+void env_hash_rebuild(void)
+{
+	uchar *data = (uchar *)gd->env_addr;
+	int i, n, size;
+
+	free(env_hash_tab);
+	env_hash_tab = NULL;
+
+	if (!gd->env_valid)
+		return;
+
+	/* count the variables */
+	for (n = 0, i = 0; i < ENV_SIZE && data[i] != '\0'; n++)
+		i += strlen((char *)data + i) + 1;
+
+	/* keep the table at most half full, leaving room to grow */
+	for (size = ENV_HASH_MIN; size < 2 * n + ENV_HASH_MIN; size <<= 1)
+		;
+	env_hash_tab = malloc(size * sizeof(int));
+	if (env_hash_tab == NULL) {
+		DEBUGF("%s: out of memory, using linear lookup\n", __func__);
+		return;
+	}
+	memset(env_hash_tab, 0xff, size * sizeof(int));	/* ENV_HASH_EMPTY */
+	env_hash_size = size;
+	env_hash_used = 0;
+	env_hash_base = gd->env_addr;
+
+	for (i = 0; i < ENV_SIZE && data[i] != '\0';
+	     i += strlen((char *)data + i) + 1)
+		env_hash_add(i);
+	env_hash_end = i;
+
+	DEBUGF("%s: %d variables, %d slots\n", __func__, n, size);
+}
+
+/*
+ * Return the offset of the "name=value" string for "name",
+ * or -1 if there is no such variable.
+ */
+int env_hash_lookup(const char *name)
+{
+	uint i = env_hash_name((uchar *)name);
+	int index;
+
+	for (i &= env_hash_size - 1;
+	     (index = env_hash_tab[i]) != ENV_HASH_EMPTY;
+	     i = (i + 1) & (env_hash_size - 1)) {
+		if (index >= 0 && env_hash_match((uchar *)name, index))
+			return index;
+	}
+	return -1;
+}
+
+/* offset at which a new variable is to be appended */
+int env_hash_append_offset(void)
+{
+	return env_hash_end;
+}
+
+/* a new "name=value" string has been appended at "index" */
+void env_hash_insert(int index)
+{
+	env_hash_end = index + strlen((char *)env_hash_base + index) + 1;
+
+	if (4 * (env_hash_used + 1) > 3 * env_hash_size) {
+		env_hash_rebuild();	/* grow / drop deleted slots */
+		return;
+	}
+	env_hash_add(index);
+}
+
+/* slot holding the entry at "index", found through its name */
+static int env_hash_slot(int index)
+{
+	uint i = env_hash_name((uchar *)env_hash_base + index);
+
+	for (i &= env_hash_size - 1; env_hash_tab[i] != ENV_HASH_EMPTY;
+	     i = (i + 1) & (env_hash_size - 1)) {
+		if (env_hash_tab[i] == index)
+			return i;
+	}
+	return -1;
+}
+
+/*
+ * The "len" bytes long entry at "index" is about to be removed and
+ * everything behind it moved down by "len" bytes.  Only the slots of
+ * the entries which move are touched, in order, so an updated offset
+ * never equals the old offset of an entry still to be looked up.
+ */
+void env_hash_delete(int index, int len)
+{
+	int i, next;
+
+	if ((i = env_hash_slot(index)) >= 0)
+		env_hash_tab[i] = ENV_HASH_DELETED;
+
+	for (index += len; index < env_hash_end; index = next) {
+		next = index + strlen((char *)env_hash_base + index) + 1;
+		if ((i = env_hash_slot(index)) >= 0)
+			env_hash_tab[i] = index - len;
+	}
+	env_hash_end -= len;
 }
+#endif /* CONFIG_ENV_HASH */
 
 #ifdef CONFIG_AUTO_COMPLETE
 int env_complete(char *var, int maxv, char *cmdv[], int bufsz, char *buf)
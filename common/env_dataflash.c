@@ -54,6 +54,8 @@ int saveenv(void)
 {
 	/* env must be copied to do not alter env structure in memory*/
 	unsigned char temp[CONFIG_ENV_SIZE];
+
+	env_crc_update();
 	memcpy(temp, env_ptr, CONFIG_ENV_SIZE);
 	return write_dataflash(CONFIG_ENV_ADDR, (unsigned long)temp, CONFIG_ENV_SIZE);
 }
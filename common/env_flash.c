@@ -145,6 +145,8 @@ int saveenv(void)
 	ulong up_data = 0;
 #endif
 
+	env_crc_update();
+
 	debug ("Protect off %08lX ... %08lX\n",
 		(ulong)flash_addr, end_addr);
 
@@ -271,6 +273,8 @@ int saveenv(void)
 #endif	/* CONFIG_ENV_SECT_SIZE */
 	int rcode = 0;
 
+	env_crc_update();
+
 #if defined(CONFIG_ENV_SECT_SIZE) && (CONFIG_ENV_SECT_SIZE > CONFIG_ENV_SIZE)
 
 	flash_offset    = ((ulong)flash_addr) & (CONFIG_ENV_SECT_SIZE-1);
@@ -195,6 +195,7 @@ int saveenv(void)
 	int ret = 0;
 	nand_erase_options_t nand_erase_options;
 
+	env_crc_update();
 	env_ptr->flags++;
 
 	nand_erase_options.length = CONFIG_ENV_RANGE;
@@ -244,6 +245,7 @@ int saveenv(void)
 
 	if (CONFIG_ENV_RANGE < CONFIG_ENV_SIZE)
 		return 1;
+	env_crc_update();
 	puts ("Erasing Nand...\n");
 	if (nand_erase_opts(&nand_info[0], &nand_erase_options))
 		return 1;
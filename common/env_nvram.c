@@ -103,6 +103,8 @@ void env_relocate_spec (void)
 int saveenv (void)
 {
 	int rcode = 0;
+
+	env_crc_update();
 #ifdef CONFIG_AMIGAONEG3SE
 	enable_nvram();
 #endif
@@ -70,6 +70,8 @@ int saveenv(void)
 		return 1;
 	}
 
+	env_crc_update();
+
 	/* Is the sector larger than the env (i.e. embedded) */
 	if (CONFIG_ENV_SECT_SIZE > CONFIG_ENV_SIZE) {
 		saved_size = CONFIG_ENV_SECT_SIZE - CONFIG_ENV_SIZE;
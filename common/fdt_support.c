@@ -29,6 +29,7 @@
 #include <fdt.h>
 #include <libfdt.h>
 #include <fdt_support.h>
+#include <bootstage.h>
 #include <exports.h>
 
 /*
@@ -279,6 +280,10 @@ int fdt_chosen(void *fdt, int force)
 	}
 #endif
 
+#ifdef CONFIG_BOOTSTAGE_FDT
+	bootstage_fdt_add(fdt);
+#endif
+
 	return err;
 }
 
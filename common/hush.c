@@ -1561,6 +1561,7 @@ static int run_pipe_real(struct pipe *pi)
 	struct child_prog *child;
 	cmd_tbl_t *cmdtp;
 	char *p;
+	int sp;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
 	(void) &i;
@@ -1627,6 +1628,8 @@ static int run_pipe_real(struct pipe *pi)
 			}
 			return EXIT_SUCCESS;   /* don't worry about errors in set_local_var() yet */
 		}
+		/* the pipe may be run again: leave child->sp alone */
+		sp = child->sp;
 		for (i = 0; is_assignment(child->argv[i]); i++) {
 			p = insert_var_value(child->argv[i]);
 #ifndef __U_BOOT__
@@ -1635,11 +1638,11 @@ static int run_pipe_real(struct pipe *pi)
 			set_local_var(p, 0);
 #endif
 			if (p != child->argv[i]) {
-				child->sp--;
+				sp--;
 				free(p);
 			}
 		}
-		if (child->sp) {
+		if (sp) {
 			char * str = NULL;
 
 			str = make_string((child->argv + i));
@@ -1802,11 +1805,28 @@ static int run_pipe_real(struct pipe *pi)
 	return -1;
 }
 
+/*
+ * Undo the variable substitution of a "for" loop which is left early,
+ * so the pipe list can be run again.
+ */
+static void for_restore(struct pipe *pi, char **list, char **save_list,
+			char *save_name)
+{
+	if (list == NULL)
+		return;
+	free(pi->progs->argv[0]);
+	while (*list)
+		free(*list++);
+	free(save_list);
+	pi->progs->argv[0] = save_name;
+}
+
 static int run_list_real(struct pipe *pi)
 {
 	char *save_name = NULL;
 	char **list = NULL;
 	char **save_list = NULL;
+	struct pipe *for_pi = NULL;
 	struct pipe *rpipe;
 	int flag_rep = 0;
 #ifndef __U_BOOT__
@@ -1846,6 +1866,8 @@ static int run_list_real(struct pipe *pi)
 				/* check Ctrl-C */
 				ctrlc();
 				if ((had_ctrlc())) {
+					for_restore(for_pi, list, save_list,
+						    save_name);
 					return 1;
 				}
 #endif
@@ -1876,6 +1898,7 @@ static int run_list_real(struct pipe *pi)
 					pi->progs->argv[0]);
 				save_list = list;
 				save_name = pi->progs->argv[0];
+				for_pi = pi;
 				pi->progs->argv[0] = NULL;
 				flag_rep = 1;
 			}
@@ -1946,6 +1969,7 @@ static int run_list_real(struct pipe *pi)
 #else
 		if (rcode < -1) {
 			last_return_code = -rcode - 2;
+			for_restore(for_pi, list, save_list, save_name);
 			return -2;	/* exit */
 		}
 		last_return_code=(rcode == 0) ? 0 : 1;
@@ -1966,6 +1990,7 @@ static int run_list_real(struct pipe *pi)
 		checkjobs(NULL);
 #endif
 	}
+	for_restore(for_pi, list, save_list, save_name);
 	return rcode;
 }
 
@@ -3252,6 +3277,180 @@ int parse_string_outer(char *s, int flag)
 #endif
 }
 
+#if defined(__U_BOOT__) && defined(CONFIG_HUSH_PARSE_CACHE)
+/*
+ * "run" keeps the parsed pipe lists of the variables it runs, so a
+ * script which is run again (from a loop or another script) is not
+ * parsed again.  An entry is used as long as the variable still has
+ * the text it was parsed from; setenv drops it right away.
+ */
+#ifndef CONFIG_SYS_HUSH_PARSE_CACHE_ENTRIES
+#define CONFIG_SYS_HUSH_PARSE_CACHE_ENTRIES	8
+#endif
+
+struct parse_cache {
+	char *name;		/* NULL if unused */
+	char *text;		/* value the list was parsed from */
+	struct pipe *list;
+	int busy;		/* the list is being run */
+	int stale;		/* free it once it is no longer busy */
+	unsigned long used;	/* for LRU replacement */
+};
+
+static struct parse_cache parse_cache[CONFIG_SYS_HUSH_PARSE_CACHE_ENTRIES];
+static unsigned long parse_cache_clock;
+
+static void parse_cache_free(struct parse_cache *c)
+{
+	if (c->busy) {
+		c->stale = 1;
+		return;
+	}
+	free_pipe_list(c->list, 0);
+	free(c->name);
+	free(c->text);
+	memset(c, 0, sizeof(*c));
+}
+
+void hush_cache_invalidate(const char *name)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_SYS_HUSH_PARSE_CACHE_ENTRIES; i++) {
+		struct parse_cache *c = &parse_cache[i];
+
+		if (c->name == NULL)
+			continue;
+		/* IFS changes the way every script is parsed */
+		if (name == NULL || strcmp(name, "IFS") == 0 ||
+		    strcmp(name, c->name) == 0)
+			parse_cache_free(c);
+	}
+}
+
+/*
+ * Parse the first line of s like parse_stream_outer() does, but don't
+ * run it.  Returns NULL on syntax errors.
+ */
+static struct pipe *parse_list(char *s, int flag)
+{
+	struct in_str input;
+	struct p_context ctx;
+	o_string temp = NULL_O_STRING;
+	struct pipe *list = NULL;
+	char *p;
+	int rcode;
+
+	if (!(p = strchr(s, '\n')) || *++p) {
+		p = xmalloc(strlen(s) + 2);
+		strcpy(p, s);
+		strcat(p, "\n");
+		s = p;
+	} else {
+		p = NULL;
+	}
+	setup_string_in_str(&input, s);
+
+	ctx.type = flag;
+	initialize_context(&ctx);
+	update_ifs_map();
+	if (!(flag & FLAG_PARSE_SEMICOLON) || (flag & FLAG_REPARSING)) mapset((uchar *)";$&|", 0);
+	input.promptmode = 1;
+	rcode = parse_stream(&temp, &ctx, &input, '\n');
+	if (rcode != 1 && ctx.old_flag != 0)
+		syntax();
+	if (rcode != 1 && ctx.old_flag == 0) {
+		done_word(&temp, &ctx);
+		done_pipe(&ctx, PIPE_SEQ);
+		list = ctx.list_head;
+	} else {
+		flag_repeat = 0;
+		if (ctx.old_flag != 0)
+			free(ctx.stack);
+		free_pipe_list(ctx.list_head, 0);
+	}
+	b_free(&temp);
+	free(p);
+	return list;
+}
+
+/*
+ * Run the value s of the environment variable name, as
+ * parse_string_outer(s, flag) would, from the cache if possible.
+ */
+int parse_string_cached(const char *name, char *s, int flag)
+{
+	struct parse_cache *c = NULL, *lru = NULL;
+	struct pipe *list;
+	int i, code;
+
+	if (!s || !*s)
+		return 1;
+	if (!(flag & FLAG_EXIT_FROM_LOOP))	/* more than one line */
+		return parse_string_outer(s, flag);
+
+	for (i = 0; i < CONFIG_SYS_HUSH_PARSE_CACHE_ENTRIES; i++) {
+		struct parse_cache *e = &parse_cache[i];
+
+		if (e->name && !e->stale && strcmp(e->name, name) == 0) {
+			if (strcmp(e->text, s) == 0)
+				c = e;
+			else
+				parse_cache_free(e);
+			break;
+		}
+	}
+
+	/* a script running itself gets a list of its own */
+	if (c && c->busy)
+		return parse_string_outer(s, flag);
+
+	if (c == NULL) {
+		list = parse_list(s, flag);
+		if (list == NULL)
+			return 0;	/* as parse_stream_outer() */
+
+		for (i = 0; i < CONFIG_SYS_HUSH_PARSE_CACHE_ENTRIES; i++) {
+			struct parse_cache *e = &parse_cache[i];
+
+			if (e->busy)
+				continue;
+			if (e->name == NULL) {
+				lru = e;
+				break;
+			}
+			if (lru == NULL || e->used < lru->used)
+				lru = e;
+		}
+		if (lru == NULL) {	/* all entries are running */
+			code = run_list(list);
+			goto out;
+		}
+		if (lru->name)
+			parse_cache_free(lru);
+		c = lru;
+		c->name = xmalloc(strlen(name) + 1);
+		strcpy(c->name, name);
+		c->text = xmalloc(strlen(s) + 1);
+		strcpy(c->text, s);
+		c->list = list;
+	}
+
+	c->used = ++parse_cache_clock;
+	c->busy++;
+	code = run_list_real(c->list);
+	c->busy--;
+	if (c->stale)
+		parse_cache_free(c);
+out:
+	if (code == -2)		/* exit */
+		code = 0;
+	if (code == -1)
+		flag_repeat = 0;
+	return (code != 0) ? 1 : 0;
+}
+#endif /* __U_BOOT__ && CONFIG_HUSH_PARSE_CACHE */
+
 #ifndef __U_BOOT__
 static int parse_file_outer(FILE *f)
 #else
@@ -2398,6 +2398,107 @@ int fit_set_timestamp (void *fit, int noffset, time_t timestamp)
 	return 0;
 }
 
+/*
+ * State of one hash calculation, see fit_hash_init()
+ */
+enum { FIT_HASH_CRC32, FIT_HASH_SHA1, FIT_HASH_MD5 };
+
+struct fit_hash {
+	const char	*algo;
+	int		type;		/* FIT_HASH_* */
+	int		noffset;	/* hash node, when checking a FIT */
+	uint8_t		*fit_value;	/* expected value, ditto */
+	int		fit_value_len;
+	union {
+		uint32_t		crc32;
+		sha1_context		sha1;
+		struct MD5Context	md5;
+	} ctx;
+};
+
+/**
+ * fit_hash_init - start a hash calculation
+ * @hash: pointer to the hash state
+ * @algo: requested hash algorithm
+ *
+ * returns:
+ *     0, on success
+ *    -1, when algo is unsupported
+ */
+static int fit_hash_init (struct fit_hash *hash, const char *algo)
+{
+	hash->algo = algo;
+	if (strcmp (algo, "crc32") == 0) {
+		hash->type = FIT_HASH_CRC32;
+		hash->ctx.crc32 = 0;
+	} else if (strcmp (algo, "sha1") == 0) {
+		hash->type = FIT_HASH_SHA1;
+		sha1_starts (&hash->ctx.sha1);
+	} else if (strcmp (algo, "md5") == 0) {
+		hash->type = FIT_HASH_MD5;
+		MD5Init (&hash->ctx.md5);
+	} else {
+		debug ("Unsupported hash alogrithm\n");
+		return -1;
+	}
+	return 0;
+}
+
+static void fit_hash_update (struct fit_hash *hash, const void *data,
+			int len)
+{
+	switch (hash->type) {
+	case FIT_HASH_CRC32:
+		hash->ctx.crc32 = crc32 (hash->ctx.crc32, data, len);
+		break;
+	case FIT_HASH_SHA1:
+		sha1_update (&hash->ctx.sha1, (unsigned char *)data, len);
+		break;
+	case FIT_HASH_MD5:
+		MD5Update (&hash->ctx.md5, data, len);
+		break;
+	}
+}
+
+static int fit_hash_final (struct fit_hash *hash, uint8_t *value)
+{
+	switch (hash->type) {
+	case FIT_HASH_CRC32:
+		*((uint32_t *)value) = cpu_to_uimage (hash->ctx.crc32);
+		return 4;
+	case FIT_HASH_SHA1:
+		sha1_finish (&hash->ctx.sha1, value);
+		return 20;
+	default:
+		MD5Final (value, &hash->ctx.md5);
+		return 16;
+	}
+}
+
+/*
+ * Feed the data to all hash states in one pass, a chunk at a time
+ */
+static void fit_hash_data (struct fit_hash *hashes, int count,
+			const void *data, int data_len)
+{
+	const uint8_t *curr = data;
+	const uint8_t *end = curr + data_len;
+	int chunk, i;
+
+	while (curr < end) {
+		chunk = end - curr;
+		if (chunk > CHUNKSZ_FIT_HASH)
+			chunk = CHUNKSZ_FIT_HASH;
+		for (i = 0; i < count; i++)
+			fit_hash_update (&hashes[i], curr, chunk);
+		curr += chunk;
+#if defined(CONFIG_HW_WATCHDOG) || defined(CONFIG_WATCHDOG)
+		WATCHDOG_RESET ();
+#endif
+	}
+}
+
+#ifdef USE_HOSTCC
 /**
  * calculate_hash - calculate and return hash for provided input data
  * @data: pointer to the input data
@@ -2418,26 +2519,15 @@ int fit_set_timestamp (void *fit, int noffset, time_t timestamp)
 static int calculate_hash (const void *data, int data_len, const char *algo,
 			uint8_t *value, int *value_len)
 {
-	if (strcmp (algo, "crc32") == 0 ) {
-		*((uint32_t *)value) = crc32_wd (0, data, data_len,
-							CHUNKSZ_CRC32);
-		*((uint32_t *)value) = cpu_to_uimage (*((uint32_t *)value));
-		*value_len = 4;
-	} else if (strcmp (algo, "sha1") == 0 ) {
-		sha1_csum_wd ((unsigned char *) data, data_len,
-				(unsigned char *) value, CHUNKSZ_SHA1);
-		*value_len = 20;
-	} else if (strcmp (algo, "md5") == 0 ) {
-		md5_wd ((unsigned char *)data, data_len, value, CHUNKSZ_MD5);
-		*value_len = 16;
-	} else {
-		debug ("Unsupported hash alogrithm\n");
+	struct fit_hash hash;
+
+	if (fit_hash_init (&hash, algo))
 		return -1;
-	}
+	fit_hash_data (&hash, 1, data, data_len);
+	*value_len = fit_hash_final (&hash, value);
 	return 0;
 }
 
-#ifdef USE_HOSTCC
 /**
  * fit_set_hashes - process FIT component image nodes and calculate hashes
  * @fit: pointer to the FIT format image header
@@ -2608,6 +2698,43 @@ int fit_image_hash_set_value (void *fit, int noffset, uint8_t *value,
 }
 #endif /* USE_HOSTCC */
 
+/*
+ * Finish the pending hash calculations of an image and compare the
+ * results with the values from the hash nodes.
+ */
+static int fit_image_check_hash_values (const void *fit, int image_noffset,
+			struct fit_hash *hashes, int count,
+			const void *data, size_t size)
+{
+	uint8_t		value[FIT_MAX_HASH_LEN];
+	int		value_len;
+	char		*err_msg;
+	int		i;
+
+	fit_hash_data (hashes, count, data, size);
+
+	for (i = 0; i < count; i++) {
+		printf ("%s", hashes[i].algo);
+
+		value_len = fit_hash_final (&hashes[i], value);
+		if (value_len != hashes[i].fit_value_len) {
+			err_msg = " error !\nBad hash value len";
+			goto error;
+		} else if (memcmp (value, hashes[i].fit_value, value_len) != 0) {
+			err_msg = " error!\nBad hash value";
+			goto error;
+		}
+		printf ("+ ");
+	}
+	return 1;
+
+error:
+	printf ("%s for '%s' hash node in '%s' image node\n",
+			err_msg, fit_get_name (fit, hashes[i].noffset, NULL),
+			fit_get_name (fit, image_noffset, NULL));
+	return 0;
+}
+
 /**
  * fit_image_check_hashes - verify data intergity
  * @fit: pointer to the FIT format image header
@@ -2626,10 +2753,8 @@ int fit_image_check_hashes (const void *fit, int image_noffset)
 	const void	*data;
 	size_t		size;
 	char		*algo;
-	uint8_t		*fit_value;
-	int		fit_value_len;
-	uint8_t		value[FIT_MAX_HASH_LEN];
-	int		value_len;
+	struct fit_hash	hashes[FIT_MAX_HASHES];
+	int		count = 0;
 	int		noffset;
 	int		ndepth;
 	char		*err_msg = "";
@@ -2640,7 +2765,11 @@ int fit_image_check_hashes (const void *fit, int image_noffset)
 		return 0;
 	}
 
-	/* Process all hash subnodes of the component image node */
+	/*
+	 * Process all hash subnodes of the component image node. The
+	 * hashes are collected and then calculated together, in a
+	 * single pass over the image data.
+	 */
 	for (ndepth = 0, noffset = fdt_next_node (fit, image_noffset, &ndepth);
 	     (noffset >= 0) && (ndepth > 0);
 	     noffset = fdt_next_node (fit, noffset, &ndepth)) {
@@ -2662,31 +2791,36 @@ int fit_image_check_hashes (const void *fit, int image_noffset)
 						"property";
 				goto error;
 			}
-			printf ("%s", algo);
 
-			if (fit_image_hash_get_value (fit, noffset, &fit_value,
-							&fit_value_len)) {
+			if (fit_image_hash_get_value (fit, noffset,
+					&hashes[count].fit_value,
+					&hashes[count].fit_value_len)) {
+				printf ("%s", algo);
 				err_msg = " error!\nCan't get hash value "
 						"property";
 				goto error;
 			}
 
-			if (calculate_hash (data, size, algo, value, &value_len)) {
+			if (fit_hash_init (&hashes[count], algo)) {
+				printf ("%s", algo);
 				err_msg = " error!\nUnsupported hash algorithm";
 				goto error;
 			}
-
-			if (value_len != fit_value_len) {
-				err_msg = " error !\nBad hash value len";
-				goto error;
-			} else if (memcmp (value, fit_value, value_len) != 0) {
-				err_msg = " error!\nBad hash value";
-				goto error;
+			hashes[count].noffset = noffset;
+
+			if (++count == FIT_MAX_HASHES) {
+				if (!fit_image_check_hash_values (fit,
+						image_noffset, hashes, count,
+						data, size))
+					return 0;
+				count = 0;
 			}
-			printf ("+ ");
 		}
 	}
 
+	if (count)
+		return fit_image_check_hash_values (fit, image_noffset,
+				hashes, count, data, size);
 	return 1;
 
 error:
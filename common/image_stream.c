@@ -0,0 +1,409 @@
+/*
+ * (C) Copyright 2010
+ * The U-Boot Authors
+ *
+ * Unpack legacy images while they are being received.
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * A loader (e.g. TFTP) feeds the file it receives chunk by chunk into
+ * image_stream_write().  If the file turns out to be a compressed
+ * legacy image, the payload is uncompressed right away to the address
+ * following the image header, and the data CRC is computed on the fly.
+ * image_stream_finish() then stores an uncompressed image header in
+ * front of the data, so the result is an ordinary IH_COMP_NONE image.
+ * This overlaps download and decompression and the compressed image
+ * never needs to be kept in RAM.
+ *
+ * Files which are not unpacked end up at the start address just as if
+ * the caller had stored them itself, so the data must go to RAM.
+ */
+
+#include <common.h>
+#include <image.h>
+#include <malloc.h>
+#include <watchdog.h>
+#include <u-boot/zlib.h>
+
+#ifdef CONFIG_LZMA
+#include <lzma/LzmaTypes.h>
+#include <lzma/LzmaDec.h>
+#endif
+
+#define STREAM_HEADER	0	/* collecting the image header		*/
+#define STREAM_PASS	1	/* not for us, caller stores the file	*/
+#define STREAM_DATA	2	/* uncompressing the payload		*/
+#define STREAM_END	3	/* end of compressed data seen		*/
+#define STREAM_ERROR	4
+
+#ifdef CONFIG_LZMA
+/* LZMA "alone" header: properties and 64 bit uncompressed size */
+#define LZMA_HDR_SIZE	(LZMA_PROPS_SIZE + 8)
+#endif
+
+static struct {
+	int		state;
+	image_header_t	hdr;		/* copy of the original header	*/
+	ulong		hdr_len;	/* header bytes collected	*/
+	ulong		data_len;	/* payload bytes seen		*/
+	uint32_t	dcrc;		/* CRC of the payload		*/
+	uint32_t	ocrc;		/* CRC of the uncompressed data	*/
+	uchar		*dst;		/* uncompressed data goes here	*/
+	ulong		dst_len;	/* room at dst			*/
+	ulong		out_len;	/* bytes written to dst		*/
+#ifdef CONFIG_GZIP
+	z_stream	zs;
+#endif
+#ifdef CONFIG_LZMA
+	CLzmaDec	lzma;
+	uchar		lzma_hdr[LZMA_HDR_SIZE];
+	ulong		lzma_hdr_len;
+	ulong		lzma_size;	/* uncompressed size, ~0 if unknown */
+#endif
+} stream;
+
+static ulong stream_addr;		/* where the image header goes	*/
+
+#ifdef CONFIG_LZMA
+static void *SzAlloc(void *p, size_t size) { return malloc(size); }
+static void SzFree(void *p, void *address) { free(address); }
+static ISzAlloc lzma_alloc = { SzAlloc, SzFree };
+#endif
+
+#ifdef CONFIG_GZIP
+extern void *zalloc(void *, unsigned, unsigned);
+extern void zfree(void *, void *, unsigned);
+
+static int stream_gzip_start(void)
+{
+	memset(&stream.zs, 0, sizeof(stream.zs));
+	stream.zs.zalloc = zalloc;
+	stream.zs.zfree = zfree;
+#if defined(CONFIG_HW_WATCHDOG) || defined(CONFIG_WATCHDOG)
+	stream.zs.outcb = (cb_func)WATCHDOG_RESET;
+#else
+	stream.zs.outcb = Z_NULL;
+#endif
+	/* let zlib parse the gzip header and check the trailer */
+	if (inflateInit2(&stream.zs, 16 + MAX_WBITS) != Z_OK)
+		return -1;
+
+	stream.zs.next_out = stream.dst;
+	stream.zs.avail_out = stream.dst_len;
+	return 0;
+}
+
+static int stream_gzip(const uchar *buf, ulong len)
+{
+	int r;
+
+	stream.zs.next_in = (Bytef *)buf;
+	stream.zs.avail_in = len;
+
+	r = inflate(&stream.zs, Z_SYNC_FLUSH);
+	stream.out_len = stream.zs.next_out - stream.dst;
+
+	if (r == Z_STREAM_END) {
+		/* gzip keeps the CRC of the uncompressed data for us */
+		stream.ocrc = stream.zs.adler;
+		inflateEnd(&stream.zs);
+		stream.state = STREAM_END;
+		return 0;
+	}
+	if (r != Z_OK && r != Z_BUF_ERROR) {
+		printf("Error: inflate() returned %d\n", r);
+		inflateEnd(&stream.zs);
+		return -1;
+	}
+	if (stream.zs.avail_out == 0 && stream.zs.avail_in) {
+		puts("Error: uncompressed image too large\n");
+		inflateEnd(&stream.zs);
+		return -1;
+	}
+	return 0;
+}
+#endif /* CONFIG_GZIP */
+
+#ifdef CONFIG_LZMA
+static int stream_lzma(const uchar *buf, ulong len)
+{
+	ELzmaStatus status;
+	SizeT in_len, old_pos;
+	SRes res;
+	int i;
+
+	if (stream.lzma_hdr_len < LZMA_HDR_SIZE) {
+		ulong n = min(len, LZMA_HDR_SIZE - stream.lzma_hdr_len);
+
+		memcpy(stream.lzma_hdr + stream.lzma_hdr_len, buf, n);
+		stream.lzma_hdr_len += n;
+		buf += n;
+		len -= n;
+		if (stream.lzma_hdr_len < LZMA_HDR_SIZE)
+			return 0;
+
+		/* all ones means unknown size, the stream has an end mark */
+		stream.lzma_size = ~0UL;
+		for (i = 4; i < 8; i++)
+			if (stream.lzma_hdr[LZMA_PROPS_SIZE + i] != 0xff)
+				break;
+		if (i < 8) {
+			if (stream.lzma_hdr[LZMA_PROPS_SIZE + 4] |
+			    stream.lzma_hdr[LZMA_PROPS_SIZE + 5] |
+			    stream.lzma_hdr[LZMA_PROPS_SIZE + 6] |
+			    stream.lzma_hdr[LZMA_PROPS_SIZE + 7]) {
+				puts("LZMA: 64bit support not enabled.\n");
+				return -1;
+			}
+			stream.lzma_size = 0;
+			for (i = 0; i < 4; i++)
+				stream.lzma_size |= (ulong)
+					stream.lzma_hdr[LZMA_PROPS_SIZE + i] << (i * 8);
+			if (stream.lzma_size > stream.dst_len) {
+				puts("LZMA: uncompressed image too large\n");
+				return -1;
+			}
+		}
+
+		LzmaDec_Construct(&stream.lzma);
+		if (LzmaDec_AllocateProbs(&stream.lzma, stream.lzma_hdr,
+					  LZMA_PROPS_SIZE, &lzma_alloc) != SZ_OK)
+			return -1;
+		/* the output buffer doubles as the dictionary */
+		stream.lzma.dic = stream.dst;
+		stream.lzma.dicBufSize = stream.dst_len;
+		LzmaDec_Init(&stream.lzma);
+	}
+
+	while (len) {
+		in_len = len;
+		old_pos = stream.lzma.dicPos;
+		res = LzmaDec_DecodeToDic(&stream.lzma,
+					  min(stream.lzma_size, stream.dst_len),
+					  buf, &in_len, LZMA_FINISH_ANY, &status);
+		stream.ocrc = crc32(stream.ocrc, stream.dst + old_pos,
+				    stream.lzma.dicPos - old_pos);
+		stream.out_len = stream.lzma.dicPos;
+		buf += in_len;
+		len -= in_len;
+		WATCHDOG_RESET();
+
+		if (res != SZ_OK) {
+			printf("LZMA: uncompress error %d\n", res);
+			goto err;
+		}
+		if (status == LZMA_STATUS_FINISHED_WITH_MARK ||
+		    stream.lzma.dicPos == stream.lzma_size) {
+			stream.state = STREAM_END;
+			break;
+		}
+		if (in_len == 0) {
+			if (stream.lzma.dicPos < stream.dst_len)
+				break;
+			puts("LZMA: uncompressed image too large\n");
+			goto err;
+		}
+	}
+
+	if (stream.state == STREAM_END)
+		LzmaDec_FreeProbs(&stream.lzma, &lzma_alloc);
+	return 0;
+
+err:
+	LzmaDec_FreeProbs(&stream.lzma, &lzma_alloc);
+	return -1;
+}
+#endif /* CONFIG_LZMA */
+
+/*
+ * The header is complete: decide whether this is an image we can
+ * unpack on the fly.
+ */
+static void stream_check_header(void)
+{
+	image_header_t *hdr = &stream.hdr;
+
+	stream.state = STREAM_PASS;
+
+	if (!image_check_magic(hdr) || !image_check_hcrc(hdr))
+		return;
+	if (image_check_type(hdr, IH_TYPE_MULTI) ||
+	    image_check_type(hdr, IH_TYPE_SCRIPT))
+		return;
+
+	stream.dst = (uchar *)(stream_addr + image_get_header_size());
+	stream.dst_len = CONFIG_SYS_BOOTM_LEN;
+	stream.out_len = 0;
+	stream.ocrc = 0;
+
+	switch (image_get_comp(hdr)) {
+#ifdef CONFIG_GZIP
+	case IH_COMP_GZIP:
+		if (stream_gzip_start())
+			return;
+		break;
+#endif
+#ifdef CONFIG_LZMA
+	case IH_COMP_LZMA:
+		stream.lzma_hdr_len = 0;
+		break;
+#endif
+	default:
+		return;
+	}
+
+	stream.state = STREAM_DATA;
+}
+
+static int stream_data(const uchar *buf, ulong len)
+{
+	ulong size = image_get_data_size(&stream.hdr);
+
+	/* anything after the payload (TFTP padding, ...) is ignored */
+	if (stream.data_len + len > size)
+		len = size - stream.data_len;
+
+	stream.dcrc = crc32(stream.dcrc, buf, len);
+	stream.data_len += len;
+
+	if (stream.state != STREAM_DATA)
+		return 0;
+
+	switch (image_get_comp(&stream.hdr)) {
+#ifdef CONFIG_GZIP
+	case IH_COMP_GZIP:
+		return stream_gzip(buf, len);
+#endif
+#ifdef CONFIG_LZMA
+	case IH_COMP_LZMA:
+		return stream_lzma(buf, len);
+#endif
+	}
+	return -1;
+}
+
+/*
+ * Start a new stream; the (uncompressed) image will be placed at addr.
+ */
+void image_stream_start(ulong addr)
+{
+#ifdef CONFIG_GZIP
+	/* release the inflate state of an interrupted transfer */
+	if (stream.state == STREAM_DATA &&
+	    image_get_comp(&stream.hdr) == IH_COMP_GZIP)
+		inflateEnd(&stream.zs);
+#endif
+#ifdef CONFIG_LZMA
+	if (stream.state == STREAM_DATA &&
+	    image_get_comp(&stream.hdr) == IH_COMP_LZMA &&
+	    stream.lzma_hdr_len == LZMA_HDR_SIZE)
+		LzmaDec_FreeProbs(&stream.lzma, &lzma_alloc);
+#endif
+	stream.state = STREAM_HEADER;
+	stream.hdr_len = 0;
+	stream.data_len = 0;
+	stream.dcrc = 0;
+	stream_addr = addr;
+}
+
+/*
+ * Feed the next chunk of the file.  Returns 1 if the caller has to
+ * store the chunk itself (the file is not unpacked), 0 if the chunk
+ * was consumed and < 0 on errors.
+ */
+int image_stream_write(const uchar *buf, ulong len)
+{
+	if (stream.state == STREAM_PASS)
+		return 1;
+	if (stream.state == STREAM_ERROR)
+		return -1;
+
+	if (stream.state == STREAM_HEADER) {
+		ulong n = min(len, image_get_header_size() - stream.hdr_len);
+
+		/*
+		 * Store the header bytes where the caller would have put
+		 * them, in case this turns out not to be an image we can
+		 * handle.  For an unpacked image they get replaced by the
+		 * new header in the end.
+		 */
+		memcpy((uchar *)&stream.hdr + stream.hdr_len, buf, n);
+		memmove((uchar *)stream_addr + stream.hdr_len, buf, n);
+		stream.hdr_len += n;
+		buf += n;
+		len -= n;
+		if (stream.hdr_len < image_get_header_size())
+			return 0;
+
+		stream_check_header();
+		if (stream.state == STREAM_PASS) {
+			/* the rest of this chunk is still ours to store */
+			memmove((uchar *)stream_addr + stream.hdr_len, buf, len);
+			return 0;
+		}
+	}
+
+	if (len && stream_data(buf, len) < 0) {
+		stream.state = STREAM_ERROR;
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * All of the file has been fed.  Check the data CRC and put the header
+ * for the uncompressed image in front of the data.  Returns 1 if the
+ * file was not unpacked, 0 on success and < 0 on errors.
+ */
+int image_stream_finish(ulong *size)
+{
+	image_header_t *hdr = (image_header_t *)stream_addr;
+
+	if (stream.state == STREAM_PASS || stream.state == STREAM_HEADER)
+		return 1;
+
+	if (stream.state != STREAM_END) {
+		if (stream.state == STREAM_DATA)
+			puts("Error: compressed data ends prematurely\n");
+		return -1;
+	}
+
+	if (stream.data_len != image_get_data_size(&stream.hdr) ||
+	    stream.dcrc != image_get_dcrc(&stream.hdr)) {
+		puts("Error: bad data CRC\n");
+		return -1;
+	}
+
+	memmove(hdr, &stream.hdr, image_get_header_size());
+	image_set_comp(hdr, IH_COMP_NONE);
+	image_set_size(hdr, stream.out_len);
+	image_set_dcrc(hdr, stream.ocrc);
+	image_set_hcrc(hdr, 0);
+	image_set_hcrc(hdr, crc32(0, (uchar *)hdr, image_get_header_size()));
+
+	printf("\n   Uncompressed %s image to %lu bytes",
+	       genimg_get_comp_name(image_get_comp(&stream.hdr)),
+	       stream.out_len);
+
+	*size = image_get_header_size() + stream.out_len;
+	return 0;
+}
@@ -334,6 +334,10 @@ void main_loop (void)
 	}
 #endif /* CONFIG_VERSION_VARIABLE */
 
+#ifdef CONFIG_SYS_CMD_INDEX
+	cmd_index_init();
+#endif
+
 #ifdef CONFIG_SYS_HUSH_PARSER
 	u_boot_hush_start ();
 #endif
@@ -1440,6 +1444,10 @@ int do_run (cmd_tbl_t * cmdtp, int flag, int argc, char *argv[])
 #ifndef CONFIG_SYS_HUSH_PARSER
 		if (run_command (arg, flag) == -1)
 			return 1;
+#elif defined(CONFIG_HUSH_PARSE_CACHE)
+		if (parse_string_cached(argv[i], arg,
+		    FLAG_PARSE_SEMICOLON | FLAG_EXIT_FROM_LOOP) != 0)
+			return 1;
 #else
 		if (parse_string_outer(arg,
 		    FLAG_PARSE_SEMICOLON | FLAG_EXIT_FROM_LOOP) != 0)
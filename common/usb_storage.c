@@ -216,6 +216,7 @@ int usb_stor_scan(int mode)
 
 	/* GJ */
 	memset(usb_stor_buf, 0, sizeof(usb_stor_buf));
+	blkcache_invalidate(NULL);
 
 	if (mode == 1)
 		printf("       scanning bus for storage devices... ");
@@ -951,9 +952,58 @@ static int usb_read_capacity(ccb *srb, struct us_data *ss)
 	return -1;
 }
 
+static int usb_read_capacity_16(ccb *srb, struct us_data *ss)
+{
+	int retry;
+
+	retry = 3;
+	do {
+		memset(&srb->cmd[0], 0, 16);
+		srb->cmd[0] = SCSI_RD_CAPAC16;
+		srb->cmd[1] = SCSI_SAI_RD_CAPAC16;
+		srb->cmd[13] = 32;
+		srb->datalen = 32;
+		srb->cmdlen = 16;
+		if (ss->transport(srb, ss) == USB_STOR_TRANSPORT_GOOD)
+			return 0;
+	} while (retry--);
+
+	return -1;
+}
+
+/*
+ * READ(16)/WRITE(16) are needed for blocks beyond 2^32. They only
+ * exist with the bulk-only transport, which takes 16 byte commands.
+ */
+static int usb_need_16(unsigned long start, unsigned short blocks)
+{
+	return (unsigned long long)start + blocks > 0x100000000ULL;
+}
+
+static void usb_setup_16(ccb *srb, unsigned char opcode,
+			 unsigned long start, unsigned short blocks)
+{
+	unsigned long long lba = start;
+	int i;
+
+	memset(&srb->cmd[0], 0, 16);
+	srb->cmd[0] = opcode;
+	for (i = 0; i < 8; i++)
+		srb->cmd[2 + i] = (unsigned char)(lba >> (56 - 8 * i));
+	srb->cmd[12] = ((unsigned char) (blocks >> 8)) & 0xff;
+	srb->cmd[13] = (unsigned char) blocks & 0xff;
+	srb->cmdlen = 16;
+}
+
 static int usb_read_10(ccb *srb, struct us_data *ss, unsigned long start,
 		       unsigned short blocks)
 {
+	if (usb_need_16(start, blocks)) {
+		usb_setup_16(srb, SCSI_READ16, start, blocks);
+		USB_STOR_PRINTF("read16: start %lx blocks %x\n", start, blocks);
+		return ss->transport(srb, ss);
+	}
+
 	memset(&srb->cmd[0], 0, 12);
 	srb->cmd[0] = SCSI_READ10;
 	srb->cmd[2] = ((unsigned char) (start >> 24)) & 0xff;
@@ -970,6 +1020,12 @@ static int usb_read_10(ccb *srb, struct us_data *ss, unsigned long start,
 static int usb_write_10(ccb *srb, struct us_data *ss, unsigned long start,
 			unsigned short blocks)
 {
+	if (usb_need_16(start, blocks)) {
+		usb_setup_16(srb, SCSI_WRITE16, start, blocks);
+		USB_STOR_PRINTF("write16: start %lx blocks %x\n", start, blocks);
+		return ss->transport(srb, ss);
+	}
+
 	memset(&srb->cmd[0], 0, 12);
 	srb->cmd[0] = SCSI_WRITE10;
 	srb->cmd[2] = ((unsigned char) (start >> 24)) & 0xff;
@@ -1007,13 +1063,27 @@ static void usb_bin_fixup(struct usb_device_descriptor descriptor,
 }
 #endif /* CONFIG_USB_BIN_FIXUP */
 
-#define USB_MAX_READ_BLK 20
+/*
+ * Largest number of blocks read or written with one command. EHCI
+ * chains as many qTDs as a transfer needs, up to USB_EHCI_MAX_XFER_SIZE
+ * bytes; other host drivers keep the old limit of 20 blocks.
+ */
+static unsigned short usb_max_xfer_blk(block_dev_desc_t *dev_desc)
+{
+#ifdef CONFIG_USB_EHCI
+	unsigned long blks = USB_EHCI_MAX_XFER_SIZE / dev_desc->blksz;
+
+	return blks > 65535 ? 65535 : blks;
+#else
+	return 20;
+#endif
+}
 
 unsigned long usb_stor_read(int device, unsigned long blknr,
 			    unsigned long blkcnt, void *buffer)
 {
 	unsigned long start, blks, buf_addr;
-	unsigned short smallblks;
+	unsigned short smallblks, max_blks;
 	struct usb_device *dev;
 	int retry, i;
 	ccb *srb = &usb_ccb;
@@ -1035,6 +1105,7 @@ unsigned long usb_stor_read(int device, unsigned long blknr,
 
 	usb_disable_asynch(1); /* asynch transfer not allowed */
 	srb->lun = usb_dev_desc[device].lun;
+	max_blks = usb_max_xfer_blk(&usb_dev_desc[device]);
 	buf_addr = (unsigned long)buffer;
 	start = blknr;
 	blks = blkcnt;
@@ -1052,12 +1123,12 @@ unsigned long usb_stor_read(int device, unsigned long blknr,
 		/* XXX need some comment here */
 		retry = 2;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (blks > USB_MAX_READ_BLK)
-			smallblks = USB_MAX_READ_BLK;
+		if (blks > max_blks)
+			smallblks = max_blks;
 		else
 			smallblks = (unsigned short) blks;
 retry_it:
-		if (smallblks == USB_MAX_READ_BLK)
+		if (smallblks == max_blks)
 			usb_show_progress();
 		srb->datalen = usb_dev_desc[device].blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
@@ -1079,18 +1150,16 @@ retry_it:
 			start, smallblks, buf_addr);
 
 	usb_disable_asynch(0); /* asynch transfer allowed */
-	if (blkcnt >= USB_MAX_READ_BLK)
+	if (blkcnt >= max_blks)
 		printf("\n");
 	return blkcnt;
 }
 
-#define USB_MAX_WRITE_BLK 20
-
 unsigned long usb_stor_write(int device, unsigned long blknr,
 				unsigned long blkcnt, const void *buffer)
 {
 	unsigned long start, blks, buf_addr;
-	unsigned short smallblks;
+	unsigned short smallblks, max_blks;
 	struct usb_device *dev;
 	int retry, i;
 	ccb *srb = &usb_ccb;
@@ -1113,6 +1182,7 @@ unsigned long usb_stor_write(int device, unsigned long blknr,
 	usb_disable_asynch(1); /* asynch transfer not allowed */
 
 	srb->lun = usb_dev_desc[device].lun;
+	max_blks = usb_max_xfer_blk(&usb_dev_desc[device]);
 	buf_addr = (unsigned long)buffer;
 	start = blknr;
 	blks = blkcnt;
@@ -1132,12 +1202,12 @@ unsigned long usb_stor_write(int device, unsigned long blknr,
 		 */
 		retry = 2;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (blks > USB_MAX_WRITE_BLK)
-			smallblks = USB_MAX_WRITE_BLK;
+		if (blks > max_blks)
+			smallblks = max_blks;
 		else
 			smallblks = (unsigned short) blks;
 retry_it:
-		if (smallblks == USB_MAX_WRITE_BLK)
+		if (smallblks == max_blks)
 			usb_show_progress();
 		srb->datalen = usb_dev_desc[device].blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
@@ -1159,7 +1229,7 @@ retry_it:
 			start, smallblks, buf_addr);
 
 	usb_disable_asynch(0); /* asynch transfer allowed */
-	if (blkcnt >= USB_MAX_WRITE_BLK)
+	if (blkcnt >= max_blks)
 		printf("\n");
 	return blkcnt;
 
@@ -1311,8 +1381,10 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 {
 	unsigned char perq, modi;
 	unsigned long cap[2];
-	unsigned long *capacity, *blksz;
+	unsigned long *blksz;
+	unsigned long long lba;
 	ccb *pccb = &usb_ccb;
+	int i;
 
 	/* for some reasons a couple of devices would not survive this reset */
 	if (
@@ -1398,13 +1470,28 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 	cap[0] = cpu_to_be32(cap[0]);
 	cap[1] = cpu_to_be32(cap[1]);
 
-	/* this assumes bigendian! */
-	cap[0] += 1;
-	capacity = &cap[0];
+	lba = (unsigned long long)cap[0] + 1;
+	if (cap[0] == 0xffffffff && ss->protocol == US_PR_BULK) {
+		/* 2^32 blocks or more: get the 64 bit capacity */
+		pccb->pdata = usb_stor_buf;
+		if (usb_read_capacity_16(pccb, ss) == 0) {
+			lba = 0;
+			for (i = 0; i < 8; i++)
+				lba = (lba << 8) | usb_stor_buf[i];
+			lba += 1;
+			cap[1] = be32_to_cpu(*(u32 *)&usb_stor_buf[8]);
+		}
+	}
+	if (lba > (lbaint_t)~0) {
+		printf("Only the first %lu blocks are accessible\n",
+		       (ulong)(lbaint_t)~0);
+		lba = (lbaint_t)~0;
+	}
+
 	blksz = &cap[1];
-	USB_STOR_PRINTF("Capacity = 0x%lx, blocksz = 0x%lx\n",
-			*capacity, *blksz);
-	dev_desc->lba = *capacity;
+	USB_STOR_PRINTF("Capacity = 0x%llx, blocksz = 0x%lx\n",
+			lba, *blksz);
+	dev_desc->lba = lba;
 	dev_desc->blksz = *blksz;
 	dev_desc->type = perq;
 	USB_STOR_PRINTF(" address %d\n", dev_desc->target);
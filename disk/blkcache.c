@@ -0,0 +1,225 @@
+/*
+ * (C) Copyright 2010
+ * The U-Boot Authors
+ *
+ * Block device read cache
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The filesystem drivers issue lots of small reads (single sectors
+ * for unaligned ext2/reiserfs accesses, FAT table blocks, directory
+ * clusters, ISO volume descriptors). Every one of those is a full
+ * command round trip on USB or SD media.
+ *
+ * Requests of fewer than CONFIG_SYS_BLOCK_CACHE_READAHEAD blocks are
+ * served from a small LRU cache. Each entry holds a naturally aligned
+ * window of CONFIG_SYS_BLOCK_CACHE_READAHEAD blocks, so a miss reads
+ * the whole window in one command and sequential small reads hit on
+ * the following blocks. Larger requests go straight to the driver.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <part.h>
+#include <linux/list.h>
+
+#ifndef CONFIG_SYS_BLOCK_CACHE_ENTRIES
+#define CONFIG_SYS_BLOCK_CACHE_ENTRIES		32
+#endif
+
+#ifndef CONFIG_SYS_BLOCK_CACHE_READAHEAD
+#define CONFIG_SYS_BLOCK_CACHE_READAHEAD	8	/* power of 2 */
+#endif
+
+#define BLKCACHE_WIN	((lbaint_t)CONFIG_SYS_BLOCK_CACHE_READAHEAD)
+
+#if (CONFIG_SYS_BLOCK_CACHE_READAHEAD & (CONFIG_SYS_BLOCK_CACHE_READAHEAD - 1))
+#error CONFIG_SYS_BLOCK_CACHE_READAHEAD must be a power of 2
+#endif
+
+struct blkcache_entry {
+	struct list_head	lru;		/* most recently used first */
+	block_dev_desc_t	*dev_desc;	/* NULL if unused */
+	lbaint_t		start;		/* first block, window aligned */
+	lbaint_t		count;		/* valid blocks in data */
+	ulong			blksz;
+	ulong			size;		/* allocated size of data */
+	uchar			*data;
+};
+
+static struct blkcache_entry blkcache[CONFIG_SYS_BLOCK_CACHE_ENTRIES];
+static LIST_HEAD(blkcache_lru);
+static struct blkcache_stats stats;
+
+static void blkcache_init(void)
+{
+	int i;
+
+	if (blkcache_lru.next != &blkcache_lru)
+		return;
+
+	for (i = 0; i < CONFIG_SYS_BLOCK_CACHE_ENTRIES; i++)
+		list_add_tail(&blkcache[i].lru, &blkcache_lru);
+}
+
+static struct blkcache_entry *blkcache_find(block_dev_desc_t *dev_desc,
+					    lbaint_t start)
+{
+	struct blkcache_entry *e;
+
+	list_for_each_entry(e, &blkcache_lru, lru) {
+		if (e->dev_desc == NULL)
+			break;	/* unused entries are kept at the tail */
+		if (e->dev_desc == dev_desc && e->start == start &&
+		    e->blksz == dev_desc->blksz)
+			return e;
+	}
+	return NULL;
+}
+
+/*
+ * Recycle the least recently used entry and fill it with the window
+ * starting at 'start'. Returns NULL if the window could not be read,
+ * in which case the caller falls back to a direct read.
+ */
+static struct blkcache_entry *blkcache_fill(block_dev_desc_t *dev_desc,
+					    lbaint_t start)
+{
+	struct blkcache_entry *e;
+	lbaint_t cnt = BLKCACHE_WIN;
+	ulong size = dev_desc->blksz * CONFIG_SYS_BLOCK_CACHE_READAHEAD;
+	ulong n;
+
+	if (dev_desc->lba && start + cnt > dev_desc->lba) {
+		if (start >= dev_desc->lba)
+			return NULL;
+		cnt = dev_desc->lba - start;
+	}
+
+	e = list_entry(blkcache_lru.prev, struct blkcache_entry, lru);
+	e->dev_desc = NULL;
+
+	if (e->size < size) {
+		free(e->data);
+		e->data = malloc(size);
+		if (e->data == NULL) {
+			e->size = 0;
+			list_move_tail(&e->lru, &blkcache_lru);
+			return NULL;
+		}
+		e->size = size;
+	}
+
+	n = dev_desc->block_read(dev_desc->dev, start, cnt, e->data);
+	if (n == 0 || n > cnt) {
+		list_move_tail(&e->lru, &blkcache_lru);
+		return NULL;
+	}
+
+	e->dev_desc = dev_desc;
+	e->start = start;
+	e->count = n;
+	e->blksz = dev_desc->blksz;
+	list_move(&e->lru, &blkcache_lru);
+	return e;
+}
+
+ulong blkcache_read(block_dev_desc_t *dev_desc, lbaint_t start,
+		    lbaint_t blkcnt, void *buffer)
+{
+	struct blkcache_entry *e;
+	uchar *dst = buffer;
+	lbaint_t done = 0;
+
+	blkcache_init();
+
+	if (blkcnt >= BLKCACHE_WIN || dev_desc->blksz == 0) {
+		stats.bypass++;
+		return dev_desc->block_read(dev_desc->dev, start, blkcnt,
+					    buffer);
+	}
+
+	while (done < blkcnt) {
+		lbaint_t blk = start + done;
+		lbaint_t win = blk & ~(BLKCACHE_WIN - 1);
+		lbaint_t ofs = blk - win;
+		lbaint_t cnt;
+
+		e = blkcache_find(dev_desc, win);
+		if (e) {
+			stats.hits++;
+			list_move(&e->lru, &blkcache_lru);
+		} else {
+			stats.misses++;
+			e = blkcache_fill(dev_desc, win);
+		}
+
+		if (e == NULL || ofs >= e->count) {
+			/* window not readable as a whole: read directly */
+			return done + dev_desc->block_read(dev_desc->dev, blk,
+						blkcnt - done,
+						dst + done * dev_desc->blksz);
+		}
+
+		cnt = min(e->count - ofs, blkcnt - done);
+		memcpy(dst + done * dev_desc->blksz,
+		       e->data + ofs * e->blksz, cnt * e->blksz);
+		done += cnt;
+	}
+
+	return done;
+}
+
+void blkcache_invalidate(block_dev_desc_t *dev_desc)
+{
+	int i;
+
+	blkcache_init();
+
+	for (i = 0; i < CONFIG_SYS_BLOCK_CACHE_ENTRIES; i++) {
+		struct blkcache_entry *e = &blkcache[i];
+
+		if (e->dev_desc == NULL)
+			continue;
+		if (dev_desc == NULL || e->dev_desc == dev_desc) {
+			e->dev_desc = NULL;
+			list_move_tail(&e->lru, &blkcache_lru);
+		}
+	}
+}
+
+void blkcache_get_stats(struct blkcache_stats *s)
+{
+	int i;
+
+	*s = stats;
+	s->entries = CONFIG_SYS_BLOCK_CACHE_ENTRIES;
+	s->readahead = CONFIG_SYS_BLOCK_CACHE_READAHEAD;
+	s->used = 0;
+	for (i = 0; i < CONFIG_SYS_BLOCK_CACHE_ENTRIES; i++)
+		if (blkcache[i].dev_desc)
+			s->used++;
+}
+
+void blkcache_reset_stats(void)
+{
+	memset(&stats, 0, sizeof(stats));
+}
@@ -249,6 +249,8 @@ int bfin_mmc_init(bd_t *bis)
 	mmc->voltages = MMC_VDD_32_33 | MMC_VDD_33_34;
 	mmc->f_max = get_sclk();
 	mmc->f_min = mmc->f_max >> 9;
+	/* the data path is set up for a single block only */
+	mmc->b_max = 1;
 	mmc->block_dev.part_type = PART_TYPE_DOS;
 
 	mmc_register(mmc);
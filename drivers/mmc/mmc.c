@@ -135,27 +135,52 @@ mmc_bwrite(int dev_num, ulong start, lbaint_t blkcnt, const void*src)
 	return blkcnt;
 }
 
-int mmc_read_block(struct mmc *mmc, void *dst, uint blocknum)
+static int mmc_read_blocks(struct mmc *mmc, void *dst, ulong start,
+			   lbaint_t blkcnt)
 {
 	struct mmc_cmd cmd;
 	struct mmc_data data;
+	int err;
 
-	cmd.cmdidx = MMC_CMD_READ_SINGLE_BLOCK;
+	if (blkcnt > 1)
+		cmd.cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
+	else
+		cmd.cmdidx = MMC_CMD_READ_SINGLE_BLOCK;
 
 	if (mmc->high_capacity)
-		cmd.cmdarg = blocknum;
+		cmd.cmdarg = start;
 	else
-		cmd.cmdarg = blocknum * mmc->read_bl_len;
+		cmd.cmdarg = start * mmc->read_bl_len;
 
 	cmd.resp_type = MMC_RSP_R1;
 	cmd.flags = 0;
 
 	data.dest = dst;
-	data.blocks = 1;
+	data.blocks = blkcnt;
 	data.blocksize = mmc->read_bl_len;
 	data.flags = MMC_DATA_READ;
 
-	return mmc_send_cmd(mmc, &cmd, &data);
+	err = mmc_send_cmd(mmc, &cmd, &data);
+
+	if (err)
+		return err;
+
+	if (blkcnt > 1) {
+		cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
+		cmd.cmdarg = 0;
+		cmd.resp_type = MMC_RSP_R1b;
+		cmd.flags = 0;
+		err = mmc_send_cmd(mmc, &cmd, NULL);
+		if (err)
+			printf("mmc fail to send stop cmd\n");
+	}
+
+	return err;
+}
+
+int mmc_read_block(struct mmc *mmc, void *dst, uint blocknum)
+{
+	return mmc_read_blocks(mmc, dst, blocknum, 1);
 }
 
 int mmc_read(struct mmc *mmc, u64 src, uchar *dst, int size)
@@ -213,7 +238,7 @@ free_buffer:
 static ulong mmc_bread(int dev_num, ulong start, lbaint_t blkcnt, void *dst)
 {
 	int err;
-	int i;
+	lbaint_t cur, blocks_todo = blkcnt;
 	struct mmc *mmc = find_mmc_device(dev_num);
 
 	if (!mmc)
@@ -226,13 +251,20 @@ static ulong mmc_bread(int dev_num, ulong start, lbaint_t blkcnt, void *dst)
 		return 0;
 	}
 
-	for (i = start; i < start + blkcnt; i++, dst += mmc->read_bl_len) {
-		err = mmc_read_block(mmc, dst, i);
+	/* Read as many blocks per command as the host can transfer */
+	while (blocks_todo > 0) {
+		cur = (blocks_todo > mmc->b_max) ? mmc->b_max : blocks_todo;
+
+		err = mmc_read_blocks(mmc, dst, start, cur);
 
 		if (err) {
 			printf("block read failed: %d\n", err);
-			return i - start;
+			return blkcnt - blocks_todo;
 		}
+
+		blocks_todo -= cur;
+		start += cur;
+		dst += cur * mmc->read_bl_len;
 	}
 
 	return blkcnt;
@@ -850,6 +882,8 @@ int mmc_register(struct mmc *mmc)
 	mmc->block_dev.removable = 1;
 	mmc->block_dev.block_read = mmc_bread;
 	mmc->block_dev.block_write = mmc_bwrite;
+	if (!mmc->b_max)
+		mmc->b_max = CONFIG_SYS_MMC_MAX_BLK_COUNT;
 
 	INIT_LIST_HEAD (&mmc->link);
 
@@ -869,6 +903,9 @@ int mmc_init(struct mmc *mmc)
 {
 	int err;
 
+	/* the card may have been changed or written to */
+	blkcache_invalidate(&mmc->block_dev);
+
 	err = mmc->init(mmc);
 
 	if (err)
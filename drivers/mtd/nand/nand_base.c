@@ -67,6 +67,7 @@
 #include <linux/mtd/mtd.h>
 #include <linux/mtd/nand.h>
 #include <linux/mtd/nand_ecc.h>
+#include <linux/mtd/nand_bch.h>
 
 #ifdef CONFIG_MTD_PARTITIONS
 #include <linux/mtd/partitions.h>
@@ -1266,6 +1267,36 @@ static uint8_t *nand_transfer_oob(struct nand_chip *chip, uint8_t *oob,
 	return NULL;
 }
 
+/**
+ * nand_cache_read_next - [Internal] Check if the next page can be prefetched
+ * @mtd:	MTD device structure
+ * @chip:	nand chip info structure
+ * @ops:	oob ops structure
+ * @page:	page number being read
+ * @aligned:	the current page is read as a whole
+ * @remain:	bytes left to read after the current page
+ *
+ * READ CACHE SEQUENTIAL is used for whole pages within one erase block,
+ * when the read_page function does not issue commands of its own. The
+ * cache is not used for the last page, nor for partial pages, which
+ * may be read with subpage column changes.
+ */
+static int nand_cache_read_next(struct mtd_info *mtd, struct nand_chip *chip,
+				struct mtd_oob_ops *ops, int page, int aligned,
+				uint32_t remain)
+{
+	int blkcheck = (1 << (chip->phys_erase_shift - chip->page_shift)) - 1;
+
+	if (!NAND_HAS_CACHEREAD(chip) || !aligned)
+		return 0;
+	if (chip->ecc.mode == NAND_ECC_HW_OOB_FIRST &&
+	    ops->mode != MTD_OOB_RAW)
+		return 0;
+
+	/* The next page must be read whole and be in the same block */
+	return remain >= mtd->writesize && ((page + 1) & blkcheck);
+}
+
 /**
  * nand_do_read_ops - [Internal] Read data with ECC
  *
@@ -1283,6 +1314,7 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 	struct mtd_ecc_stats stats;
 	int blkcheck = (1 << (chip->phys_erase_shift - chip->page_shift)) - 1;
 	int sndcmd = 1;
+	int cached = 0;
 	int ret = 0;
 	uint32_t readlen = ops->len;
 	uint32_t oobreadlen = ops->ooblen;
@@ -1314,6 +1346,24 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 				sndcmd = 0;
 			}
 
+			/*
+			 * With a read cache, move this page to the cache
+			 * register and let the chip fetch the next page
+			 * from the array while this one is transferred.
+			 */
+			if (nand_cache_read_next(mtd, chip, ops, page,
+						 aligned, readlen - bytes)) {
+				if (!cached)
+					chip->pagebuf = -1;
+				chip->cmdfunc(mtd, NAND_CMD_READCACHESEQ,
+					      -1, -1);
+				cached = 1;
+			} else if (cached) {
+				chip->cmdfunc(mtd, NAND_CMD_READCACHEEND,
+					      -1, -1);
+				cached = 0;
+			}
+
 			/* Now read the page into the buffer */
 			if (unlikely(ops->mode == MTD_OOB_RAW))
 				ret = chip->ecc.read_page_raw(mtd, chip,
@@ -1387,12 +1437,17 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 		}
 
 		/* Check, if the chip supports auto page increment
-		 * or if we have hit a block boundary.
+		 * or if we have hit a block boundary. A running cache
+		 * read has the next page fetched already.
 		 */
-		if (!NAND_CANAUTOINCR(chip) || !(page & blkcheck))
+		if ((!NAND_CANAUTOINCR(chip) || !(page & blkcheck)) && !cached)
 			sndcmd = 1;
 	}
 
+	/* Leave cache read mode if the transfer was aborted */
+	if (cached)
+		chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
+
 	ops->retlen = ops->len - (size_t) readlen;
 	if (oob)
 		ops->oobretlen = ops->ooblen - oobreadlen;
@@ -2740,6 +2795,12 @@ static struct nand_flash_dev *nand_get_flash_type(struct mtd_info *mtd,
 	if (*maf_id != NAND_MFR_SAMSUNG && !type->pagesize)
 		chip->options &= ~NAND_SAMSUNG_LP_OPTIONS;
 
+#ifdef CONFIG_SYS_NAND_CACHE_READ
+	/* Large page chips of the board support READ CACHE SEQUENTIAL */
+	if (mtd->writesize > 512)
+		chip->options |= NAND_CACHERD;
+#endif
+
 	/* Check for AND chips with 4 page planes */
 	if (chip->options & NAND_4PAGE_ARRAY)
 		chip->erase_cmd = multi_erase_cmd;
@@ -2838,7 +2899,7 @@ int nand_scan_tail(struct mtd_info *mtd)
 	/*
 	 * If no default placement scheme is given, select an appropriate one
 	 */
-	if (!chip->ecc.layout) {
+	if (!chip->ecc.layout && (chip->ecc.mode != NAND_ECC_SOFT_BCH)) {
 		switch (mtd->oobsize) {
 		case 8:
 			chip->ecc.layout = &nand_oob_8;
@@ -2939,6 +3000,40 @@ int nand_scan_tail(struct mtd_info *mtd)
 		chip->ecc.bytes = 3;
 		break;
 
+	case NAND_ECC_SOFT_BCH:
+		if (!mtd_nand_has_bch()) {
+			printk(KERN_WARNING "CONFIG_NAND_ECC_BCH not enabled\n");
+			BUG();
+		}
+		chip->ecc.calculate = nand_bch_calculate_ecc;
+		chip->ecc.correct = nand_bch_correct_data;
+		chip->ecc.read_page = nand_read_page_swecc;
+		chip->ecc.read_subpage = nand_read_subpage;
+		chip->ecc.write_page = nand_write_page_swecc;
+		chip->ecc.read_page_raw = nand_read_page_raw;
+		chip->ecc.write_page_raw = nand_write_page_raw;
+		chip->ecc.read_oob = nand_read_oob_std;
+		chip->ecc.write_oob = nand_write_oob_std;
+		/*
+		 * Board driver should supply ecc.size and ecc.bytes values to
+		 * select how many bits are correctable; see nand_bch_init()
+		 * for details. Otherwise, default to 4 bits for large page
+		 * devices.
+		 */
+		if (!chip->ecc.size && (mtd->oobsize >= 64)) {
+			chip->ecc.size = 512;
+			chip->ecc.bytes = 7;
+		}
+		chip->ecc.priv = nand_bch_init(mtd,
+					       chip->ecc.size,
+					       chip->ecc.bytes,
+					       &chip->ecc.layout);
+		if (!chip->ecc.priv) {
+			printk(KERN_WARNING "BCH ECC initialization failed!\n");
+			BUG();
+		}
+		break;
+
 	case NAND_ECC_NONE:
 		printk(KERN_WARNING "NAND_ECC_NONE selected by board driver. "
 		       "This is not recommended !!\n");
@@ -3099,6 +3194,9 @@ void nand_release(struct mtd_info *mtd)
 	kfree(chip->bbt);
 	if (!(chip->options & NAND_OWN_BUFFERS))
 		kfree(chip->buffers);
+
+	if (chip->ecc.mode == NAND_ECC_SOFT_BCH)
+		nand_bch_free((struct nand_bch_control *)chip->ecc.priv);
 }
 
 /* XXX U-BOOT XXX */
@@ -486,7 +486,7 @@ struct spi_flash *spi_flash_probe_atmel(struct spi_slave *spi, u8 *idcode)
 		return NULL;
 	}
 
-	asf = malloc(sizeof(struct atmel_spi_flash));
+	asf = calloc(1, sizeof(struct atmel_spi_flash));
 	if (!asf) {
 		debug("SF: Failed to allocate memory\n");
 		return NULL;
@@ -314,7 +314,7 @@ struct spi_flash *spi_flash_probe_macronix(struct spi_slave *spi, u8 *idcode)
 		return NULL;
 	}
 
-	mcx = malloc(sizeof(*mcx));
+	mcx = calloc(1, sizeof(*mcx));
 	if (!mcx) {
 		debug("SF: Failed to allocate memory\n");
 		return NULL;
@@ -36,6 +36,17 @@ int spi_flash_cmd(struct spi_slave *spi, u8 cmd, void *response, size_t len)
 	return ret;
 }
 
+/* Receive the data phase of an array read, with DMA if available */
+static int spi_flash_read_data(struct spi_slave *spi, void *data,
+		size_t data_len, unsigned long flags)
+{
+#ifdef CONFIG_SPI_XFER_DMA
+	return spi_xfer_dma(spi, data_len * 8, data, flags);
+#else
+	return spi_xfer(spi, data_len * 8, NULL, data, flags);
+#endif
+}
+
 int spi_flash_cmd_read(struct spi_slave *spi, const u8 *cmd,
 		size_t cmd_len, void *data, size_t data_len)
 {
@@ -50,7 +61,7 @@ int spi_flash_cmd_read(struct spi_slave *spi, const u8 *cmd,
 		debug("SF: Failed to send read command (%zu bytes): %d\n",
 				cmd_len, ret);
 	} else if (data_len != 0) {
-		ret = spi_xfer(spi, data_len * 8, NULL, data, SPI_XFER_END);
+		ret = spi_flash_read_data(spi, data, data_len, SPI_XFER_END);
 		if (ret)
 			debug("SF: Failed to read %zu bytes of data: %d\n",
 					data_len, ret);
@@ -96,6 +107,107 @@ int spi_flash_read_common(struct spi_flash *flash, const u8 *cmd,
 	return ret;
 }
 
+int spi_flash_cmd_read_fast(struct spi_flash *flash, u32 offset,
+		size_t len, void *data)
+{
+	struct spi_slave *spi = flash->spi;
+	unsigned long addr_flags = 0;
+	unsigned long data_flags = 0;
+	size_t addr_len = 4;
+	u8 cmd[7];
+	int ret;
+
+	cmd[1] = offset >> 16;
+	cmd[2] = offset >> 8;
+	cmd[3] = offset;
+	/* Dummy byte; for quad I/O the mode byte and 4 dummy clocks */
+	cmd[4] = 0x00;
+	cmd[5] = 0x00;
+	cmd[6] = 0x00;
+
+	switch (flash->read_mode) {
+	case SPI_FLASH_RD_QUAD_IO:
+		cmd[0] = CMD_READ_ARRAY_QUAD_IO;
+		addr_len = 6;
+		addr_flags = SPI_XFER_QUAD;
+		data_flags = SPI_XFER_QUAD;
+		break;
+	case SPI_FLASH_RD_QUAD:
+		cmd[0] = CMD_READ_ARRAY_QUAD;
+		data_flags = SPI_XFER_QUAD;
+		break;
+	case SPI_FLASH_RD_DUAL:
+		cmd[0] = CMD_READ_ARRAY_DUAL;
+		data_flags = SPI_XFER_DUAL;
+		break;
+	default:
+		cmd[0] = CMD_READ_ARRAY_FAST;
+		break;
+	}
+
+	spi_claim_bus(spi);
+
+	if (addr_flags) {
+		/* Only the opcode goes out on a single wire */
+		ret = spi_xfer(spi, 8, cmd, NULL, SPI_XFER_BEGIN);
+		if (!ret)
+			ret = spi_xfer(spi, addr_len * 8, cmd + 1, NULL,
+					addr_flags);
+	} else {
+		ret = spi_xfer(spi, (1 + addr_len) * 8, cmd, NULL,
+				SPI_XFER_BEGIN);
+	}
+	if (ret) {
+		debug("SF: Failed to send read command %02x: %d\n",
+				cmd[0], ret);
+		spi_xfer(spi, 0, NULL, NULL, SPI_XFER_END);
+		goto out;
+	}
+
+	ret = spi_flash_read_data(spi, data, len, data_flags | SPI_XFER_END);
+	if (ret)
+		debug("SF: Failed to read %zu bytes of data: %d\n", len, ret);
+
+out:
+	spi_release_bus(spi);
+	return ret;
+}
+
+/*
+ * Pick the fastest read mode supported by both the chip and the SPI mode
+ * the board set up the slave with. Called with the bus claimed.
+ */
+static void spi_flash_setup_read_mode(struct spi_flash *flash,
+		unsigned int spi_mode)
+{
+	u8 modes = flash->read_modes;
+
+	if (!(spi_mode & SPI_RX_DUAL))
+		modes &= ~SPI_FLASH_RD_DUAL;
+	if (!(spi_mode & SPI_RX_QUAD))
+		modes &= ~(SPI_FLASH_RD_QUAD | SPI_FLASH_RD_QUAD_IO);
+	if (!(spi_mode & SPI_TX_QUAD))
+		modes &= ~SPI_FLASH_RD_QUAD_IO;
+
+	if ((modes & (SPI_FLASH_RD_QUAD | SPI_FLASH_RD_QUAD_IO)) &&
+	    flash->quad_enable && flash->quad_enable(flash)) {
+		debug("SF: Failed to enable quad mode\n");
+		modes &= ~(SPI_FLASH_RD_QUAD | SPI_FLASH_RD_QUAD_IO);
+	}
+
+	if (modes & SPI_FLASH_RD_QUAD_IO)
+		flash->read_mode = SPI_FLASH_RD_QUAD_IO;
+	else if (modes & SPI_FLASH_RD_QUAD)
+		flash->read_mode = SPI_FLASH_RD_QUAD;
+	else if (modes & SPI_FLASH_RD_DUAL)
+		flash->read_mode = SPI_FLASH_RD_DUAL;
+	else
+		flash->read_mode = 0;
+
+	debug("SF: Using read mode %x of %x\n", flash->read_mode,
+			flash->read_modes);
+}
+
 struct spi_flash *spi_flash_probe(unsigned int bus, unsigned int cs,
 		unsigned int max_hz, unsigned int spi_mode)
 {
@@ -104,7 +216,12 @@ struct spi_flash *spi_flash_probe(unsigned int bus, unsigned int cs,
 	int ret;
 	u8 idcode[5];
 
-	spi = spi_setup_slave(bus, cs, max_hz, spi_mode);
+	/*
+	 * The dual/quad bits only select the read command; controller
+	 * drivers may reject modes they don't know (e.g. > SPI_MODE_3).
+	 */
+	spi = spi_setup_slave(bus, cs, max_hz,
+			spi_mode & ~(SPI_RX_DUAL | SPI_RX_QUAD | SPI_TX_QUAD));
 	if (!spi) {
 		debug("SF: Failed to set up slave\n");
 		return NULL;
@@ -164,6 +281,8 @@ struct spi_flash *spi_flash_probe(unsigned int bus, unsigned int cs,
 	if (!flash)
 		goto err_manufacturer_probe;
 
+	spi_flash_setup_read_mode(flash, spi_mode);
+
 	spi_release_bus(spi);
 
 	return flash;
@@ -14,6 +14,7 @@
 #define CMD_W25_WREN		0x06	/* Write Enable */
 #define CMD_W25_WRDI		0x04	/* Write Disable */
 #define CMD_W25_RDSR		0x05	/* Read Status Register */
+#define CMD_W25_RDSR2		0x35	/* Read Status Register 2 */
 #define CMD_W25_WRSR		0x01	/* Write Status Register */
 #define CMD_W25_READ		0x03	/* Read Data Bytes */
 #define CMD_W25_FAST_READ	0x0b	/* Read Data Bytes at Higher Speed */
@@ -27,8 +28,17 @@
 #define WINBOND_ID_W25X16		0x3015
 #define WINBOND_ID_W25X32		0x3016
 #define WINBOND_ID_W25X64		0x3017
+#define WINBOND_ID_W25Q16		0x4015
+#define WINBOND_ID_W25Q32		0x4016
+#define WINBOND_ID_W25Q64		0x4017
+#define WINBOND_ID_W25Q128		0x4018
 
 #define WINBOND_SR_WIP		(1 << 0)	/* Write-in-Progress */
+#define WINBOND_SR2_QE		(1 << 1)	/* Quad Enable */
+
+#define WINBOND_RD_W25X		SPI_FLASH_RD_DUAL
+#define WINBOND_RD_W25Q		(SPI_FLASH_RD_DUAL | SPI_FLASH_RD_QUAD \
+				 | SPI_FLASH_RD_QUAD_IO)
 
 struct winbond_spi_flash_params {
 	uint16_t	id;
@@ -36,7 +46,8 @@ struct winbond_spi_flash_params {
 	uint8_t		l2_page_size;
 	uint16_t	pages_per_sector;
 	uint16_t	sectors_per_block;
-	uint8_t		nr_blocks;
+	uint16_t	nr_blocks;
+	uint8_t		read_modes;
 	const char	*name;
 };
 
@@ -59,6 +70,7 @@ static const struct winbond_spi_flash_params winbond_spi_flash_table[] = {
 		.pages_per_sector	= 16,
 		.sectors_per_block	= 16,
 		.nr_blocks		= 32,
+		.read_modes		= WINBOND_RD_W25X,
 		.name			= "W25X16",
 	},
 	{
@@ -67,6 +79,7 @@ static const struct winbond_spi_flash_params winbond_spi_flash_table[] = {
 		.pages_per_sector	= 16,
 		.sectors_per_block	= 16,
 		.nr_blocks		= 64,
+		.read_modes		= WINBOND_RD_W25X,
 		.name			= "W25X32",
 	},
 	{
@@ -75,8 +88,45 @@ static const struct winbond_spi_flash_params winbond_spi_flash_table[] = {
 		.pages_per_sector	= 16,
 		.sectors_per_block	= 16,
 		.nr_blocks		= 128,
+		.read_modes		= WINBOND_RD_W25X,
 		.name			= "W25X64",
 	},
+	{
+		.id			= WINBOND_ID_W25Q16,
+		.l2_page_size		= 8,
+		.pages_per_sector	= 16,
+		.sectors_per_block	= 16,
+		.nr_blocks		= 32,
+		.read_modes		= WINBOND_RD_W25Q,
+		.name			= "W25Q16",
+	},
+	{
+		.id			= WINBOND_ID_W25Q32,
+		.l2_page_size		= 8,
+		.pages_per_sector	= 16,
+		.sectors_per_block	= 16,
+		.nr_blocks		= 64,
+		.read_modes		= WINBOND_RD_W25Q,
+		.name			= "W25Q32",
+	},
+	{
+		.id			= WINBOND_ID_W25Q64,
+		.l2_page_size		= 8,
+		.pages_per_sector	= 16,
+		.sectors_per_block	= 16,
+		.nr_blocks		= 128,
+		.read_modes		= WINBOND_RD_W25Q,
+		.name			= "W25Q64",
+	},
+	{
+		.id			= WINBOND_ID_W25Q128,
+		.l2_page_size		= 8,
+		.pages_per_sector	= 16,
+		.sectors_per_block	= 16,
+		.nr_blocks		= 256,
+		.read_modes		= WINBOND_RD_W25Q,
+		.name			= "W25Q128",
+	},
 };
 
 static int winbond_wait_ready(struct spi_flash *flash, unsigned long timeout)
@@ -141,17 +191,51 @@ static void winbond_build_address(struct winbond_spi_flash *stm, u8 *cmd, u32 of
 	cmd[2] = byte_addr;
 }
 
-static int winbond_read_fast(struct spi_flash *flash,
-		u32 offset, size_t len, void *buf)
+/*
+ * Set the non-volatile QE bit in status register 2 of W25Q devices, which
+ * turns /WP and /HOLD into IO2 and IO3. Called with the bus claimed.
+ */
+static int winbond_quad_enable(struct spi_flash *flash)
 {
-	struct winbond_spi_flash *stm = to_winbond_spi_flash(flash);
-	u8 cmd[5];
+	u8 cmd[3];
+	u8 sr, sr2;
+	int ret;
 
-	cmd[0] = CMD_READ_ARRAY_FAST;
-	winbond_build_address(stm, cmd + 1, offset);
-	cmd[4] = 0x00;
+	ret = spi_flash_cmd(flash->spi, CMD_W25_RDSR2, &sr2, 1);
+	if (ret)
+		return ret;
+	if (sr2 & WINBOND_SR2_QE)
+		return 0;
+
+	ret = spi_flash_cmd(flash->spi, CMD_W25_RDSR, &sr, 1);
+	if (ret)
+		return ret;
+
+	ret = spi_flash_cmd(flash->spi, CMD_W25_WREN, NULL, 0);
+	if (ret < 0) {
+		debug("SF: Enabling Write failed\n");
+		return ret;
+	}
+
+	/* Writing both status registers keeps the protection bits */
+	cmd[0] = CMD_W25_WRSR;
+	cmd[1] = sr;
+	cmd[2] = sr2 | WINBOND_SR2_QE;
+	ret = spi_flash_cmd_write(flash->spi, cmd, 3, NULL, 0);
+	if (ret < 0) {
+		debug("SF: Winbond status register write failed\n");
+		return ret;
+	}
+
+	ret = winbond_wait_ready(flash, SPI_FLASH_PROG_TIMEOUT);
+	if (ret < 0)
+		return ret;
+
+	ret = spi_flash_cmd(flash->spi, CMD_W25_RDSR2, &sr2, 1);
+	if (ret)
+		return ret;
 
-	return spi_flash_read_common(flash, cmd, sizeof(cmd), buf, len);
+	return (sr2 & WINBOND_SR2_QE) ? 0 : -1;
 }
 
 static int winbond_write(struct spi_flash *flash,
@@ -305,7 +389,7 @@ struct spi_flash *spi_flash_probe_winbond(struct spi_slave *spi, u8 *idcode)
 		return NULL;
 	}
 
-	stm = malloc(sizeof(struct winbond_spi_flash));
+	stm = calloc(1, sizeof(struct winbond_spi_flash));
 	if (!stm) {
 		debug("SF: Failed to allocate memory\n");
 		return NULL;
@@ -320,7 +404,10 @@ struct spi_flash *spi_flash_probe_winbond(struct spi_slave *spi, u8 *idcode)
 
 	stm->flash.write = winbond_write;
 	stm->flash.erase = winbond_erase;
-	stm->flash.read = winbond_read_fast;
+	stm->flash.read = spi_flash_cmd_read_fast;
+	stm->flash.read_modes = params->read_modes;
+	if (params->read_modes & SPI_FLASH_RD_QUAD)
+		stm->flash.quad_enable = winbond_quad_enable;
 	stm->flash.size = page_size * params->pages_per_sector
 				* params->sectors_per_block
 				* params->nr_blocks;
@@ -0,0 +1,743 @@
+/*
+ * (C) Copyright 2010
+ * The U-Boot Authors
+ *
+ * UBI attach map
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * UBI attach map unit.
+ *
+ * Scanning reads the EC and VID headers of every physical eraseblock, which
+ * takes long on big NAND devices. The attach map is a snapshot of what
+ * scanning would find: the erase counter of each physical eraseblock, the
+ * logical eraseblock it is mapped to (or that it is free) and the per-volume
+ * information normally taken from the VID headers. It is stored in the
+ * logical eraseblocks of an internal "delete"-compatible volume, so other
+ * UBI implementations (e.g. Linux) remove it when they attach the device.
+ * LEB 0, the anchor, is kept in one of the first %UBI_ATTMAP_MAX_START
+ * physical eraseblocks, so it is found by reading just a few headers.
+ *
+ * The map is written when the device was attached by scanning and when it is
+ * detached. The anchor is erased before anything else is written to or erased
+ * from the device, so a map found on the flash always describes it. If there
+ * is no map or any of the checks fails, UBI falls back to scanning.
+ *
+ * The physical eraseblocks of the map are not handed to the wear-leveling
+ * unit, they stay reserved for the map while the device is attached. To
+ * spread the wear of rewriting the map, it is put in the least worn
+ * physical eraseblocks available each time.
+ */
+
+#include <ubi_uboot.h>
+#include "ubi.h"
+
+/**
+ * attmap_size - calculate attach map data size.
+ * @ubi: UBI device description object
+ * @vol_count: count of volume records
+ */
+static int attmap_size(const struct ubi_device *ubi, int vol_count)
+{
+	return sizeof(struct ubi_attmap_hdr) +
+	       vol_count * sizeof(struct ubi_attmap_vol) +
+	       ubi->peb_count * sizeof(struct ubi_attmap_peb);
+}
+
+/**
+ * attmap_pebs - calculate how many PEBs an attach map occupies.
+ * @ubi: UBI device description object
+ */
+static int attmap_pebs(const struct ubi_device *ubi)
+{
+	int size = attmap_size(ubi, UBI_MAX_VOLUMES + UBI_INT_VOL_COUNT);
+
+	return DIV_ROUND_UP(size, ubi->leb_size);
+}
+
+/**
+ * check_map_peb - check if a PEB contains an attach map LEB.
+ * @ubi: UBI device description object
+ * @pnum: the physical eraseblock to check
+ * @ech: buffer for the EC header
+ * @vidh: buffer for the VID header
+ * @bitflips: set to %1 if there were bit-flips
+ *
+ * This function returns %1 if @pnum has valid EC and VID headers and belongs
+ * to the attach map volume, and %0 if not.
+ */
+static int check_map_peb(struct ubi_device *ubi, int pnum,
+			 struct ubi_ec_hdr *ech, struct ubi_vid_hdr *vidh,
+			 int *bitflips)
+{
+	int err;
+
+	if (ubi_io_is_bad(ubi, pnum))
+		return 0;
+
+	err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
+	if (err == UBI_IO_BITFLIPS)
+		*bitflips = 1;
+	else if (err)
+		return 0;
+
+	if (ech->version != UBI_VERSION ||
+	    be64_to_cpu(ech->ec) > UBI_MAX_ERASECOUNTER)
+		return 0;
+
+	err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
+	if (err == UBI_IO_BITFLIPS)
+		*bitflips = 1;
+	else if (err)
+		return 0;
+
+	return be32_to_cpu(vidh->vol_id) == UBI_ATTMAP_VOLUME_ID;
+}
+
+/**
+ * add_free - add a free physical eraseblock to the scanning information.
+ * @si: scanning information
+ * @pnum: physical eraseblock number
+ * @ec: erase counter
+ */
+static int add_free(struct ubi_scan_info *si, int pnum, int ec)
+{
+	struct ubi_scan_leb *seb;
+
+	seb = kmalloc(sizeof(struct ubi_scan_leb), GFP_KERNEL);
+	if (!seb)
+		return -ENOMEM;
+
+	seb->pnum = pnum;
+	seb->ec = ec;
+	list_add_tail(&seb->u.list, &si->free);
+	return 0;
+}
+
+/**
+ * build_si - build scanning information from attach map data.
+ * @ubi: UBI device description object
+ * @si: scanning information to fill
+ * @hdr: the attach map header followed by the attach map data
+ * @vidh: a VID header buffer
+ *
+ * Used physical eraseblocks are added by means of 'ubi_scan_add_used()' using
+ * VID headers made up from the volume records, so the scanning information
+ * looks exactly as if the device was scanned. Returns zero in case of success
+ * and %-EINVAL if the attach map data is inconsistent.
+ */
+static int build_si(struct ubi_device *ubi, struct ubi_scan_info *si,
+		    const struct ubi_attmap_hdr *hdr, struct ubi_vid_hdr *vidh)
+{
+	int i, err, pnum, vol_count = be32_to_cpu(hdr->vol_count);
+	const struct ubi_attmap_vol *vols = (const void *)(hdr + 1);
+	const struct ubi_attmap_peb *pebs = (const void *)(vols + vol_count);
+	const struct ubi_attmap_vol *v = NULL;
+
+	for (i = 0; i < vol_count; i++) {
+		uint32_t vol_id = be32_to_cpu(vols[i].vol_id);
+
+		if (vol_id >= UBI_MAX_VOLUMES && vol_id != UBI_LAYOUT_VOLUME_ID)
+			return -EINVAL;
+		if (vols[i].vol_type != UBI_VID_DYNAMIC &&
+		    vols[i].vol_type != UBI_VID_STATIC)
+			return -EINVAL;
+	}
+
+	for (pnum = 0; pnum < ubi->peb_count; pnum++) {
+		uint32_t vol_id = be32_to_cpu(pebs[pnum].vol_id);
+		uint32_t lnum = be32_to_cpu(pebs[pnum].lnum);
+		uint32_t ec = be32_to_cpu(pebs[pnum].ec);
+
+		if (vol_id == UBI_ATTMAP_PEB_UNUSED)
+			continue;
+
+		if (ec > UBI_MAX_ERASECOUNTER)
+			return -EINVAL;
+
+		if (vol_id == UBI_ATTMAP_PEB_FREE) {
+			err = add_free(si, pnum, ec);
+			if (err)
+				return err;
+		} else {
+			/* Physical eraseblocks of a volume mostly go together */
+			if (!v || be32_to_cpu(v->vol_id) != vol_id) {
+				for (i = 0; i < vol_count; i++)
+					if (be32_to_cpu(vols[i].vol_id) == vol_id)
+						break;
+				if (i == vol_count)
+					return -EINVAL;
+				v = &vols[i];
+			}
+			if (lnum >= ubi->peb_count)
+				return -EINVAL;
+
+			memset(vidh, 0, sizeof(struct ubi_vid_hdr));
+			vidh->vol_type = v->vol_type;
+			vidh->compat = v->compat;
+			vidh->vol_id = v->vol_id;
+			vidh->lnum = cpu_to_be32(lnum);
+			vidh->data_size = v->last_data_size;
+			vidh->used_ebs = v->used_ebs;
+			vidh->data_pad = v->data_pad;
+
+			err = ubi_scan_add_used(ubi, si, pnum, ec, vidh, 0);
+			if (err)
+				return err;
+		}
+
+		si->ec_sum += ec;
+		si->ec_count += 1;
+		if (ec > si->max_ec)
+			si->max_ec = ec;
+	}
+
+	if (si->ec_count) {
+		do_div(si->ec_sum, si->ec_count);
+		si->mean_ec = si->ec_sum;
+	}
+
+	si->is_empty = 0;
+	si->bad_peb_count = be32_to_cpu(hdr->bad_peb_count);
+	si->max_sqnum = be64_to_cpu(hdr->sqnum);
+	return 0;
+}
+
+/**
+ * ubi_attmap_scan - build scanning information from the attach map.
+ * @ubi: UBI device description object
+ *
+ * This function looks for the attach map and, if there is a valid one, builds
+ * the scanning information from it instead of scanning the whole MTD device.
+ * Returns the scanning information in case of success, %NULL if there is no
+ * usable attach map and the device has to be scanned, and an error code in
+ * case of failure.
+ */
+struct ubi_scan_info *ubi_attmap_scan(struct ubi_device *ubi)
+{
+	int i, err, pnum, size, map_pebs, bitflips = 0;
+	unsigned long long sqnum;
+	struct ubi_attmap *am;
+	struct ubi_attmap_hdr *hdr;
+	struct ubi_ec_hdr *ech;
+	struct ubi_vid_hdr *vidh;
+	struct ubi_scan_info *si = ERR_PTR(-ENOMEM);
+	void *buf;
+
+	map_pebs = attmap_pebs(ubi);
+	if (map_pebs > UBI_ATTMAP_MAX_PEBS)
+		return NULL;
+
+	am = kzalloc(sizeof(struct ubi_attmap), GFP_KERNEL);
+	if (!am)
+		return si;
+
+	ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
+	if (!ech)
+		goto out_am;
+
+	vidh = ubi_zalloc_vid_hdr(ubi, GFP_KERNEL);
+	if (!vidh)
+		goto out_ech;
+
+	buf = vmalloc(map_pebs * ubi->leb_size);
+	if (!buf)
+		goto out_vidh;
+
+	si = NULL;
+	for (pnum = 0; pnum < UBI_ATTMAP_MAX_START; pnum++) {
+		if (pnum == ubi->peb_count)
+			break;
+
+		bitflips = 0;
+		if (check_map_peb(ubi, pnum, ech, vidh, &bitflips) &&
+		    be32_to_cpu(vidh->lnum) == 0)
+			break;
+	}
+	if (pnum == UBI_ATTMAP_MAX_START || pnum == ubi->peb_count) {
+		dbg_bld("no attach map found");
+		goto out_buf;
+	}
+
+	dbg_bld("attach map anchor at PEB %d", pnum);
+	sqnum = be64_to_cpu(vidh->sqnum);
+	am->pnum[0] = pnum;
+	am->ec[0] = be64_to_cpu(ech->ec);
+
+	hdr = buf;
+	err = ubi_io_read_data(ubi, hdr, pnum, 0,
+			       sizeof(struct ubi_attmap_hdr));
+	if (err && err != UBI_IO_BITFLIPS)
+		goto bad;
+
+	size = attmap_size(ubi, be32_to_cpu(hdr->vol_count));
+	if (be32_to_cpu(hdr->magic) != UBI_ATTMAP_MAGIC ||
+	    hdr->version != UBI_ATTMAP_VERSION ||
+	    crc32(UBI_CRC32_INIT, hdr, UBI_ATTMAP_HDR_SIZE_CRC) !=
+	    be32_to_cpu(hdr->hdr_crc))
+		goto bad;
+
+	if (be32_to_cpu(hdr->peb_count) != ubi->peb_count ||
+	    be32_to_cpu(hdr->vol_count) > UBI_MAX_VOLUMES + UBI_INT_VOL_COUNT ||
+	    be32_to_cpu(hdr->map_pebs) != map_pebs ||
+	    be32_to_cpu(hdr->data_size) !=
+	    size - sizeof(struct ubi_attmap_hdr) ||
+	    be32_to_cpu(hdr->pnum[0]) != pnum ||
+	    be64_to_cpu(hdr->sqnum) <= sqnum)
+		goto bad;
+
+	for (i = 0; i < map_pebs; i++) {
+		int len = size - i * ubi->leb_size;
+
+		if (i > 0) {
+			pnum = be32_to_cpu(hdr->pnum[i]);
+			if (pnum < 0 || pnum >= ubi->peb_count ||
+			    !check_map_peb(ubi, pnum, ech, vidh, &bitflips) ||
+			    be32_to_cpu(vidh->lnum) != i ||
+			    be64_to_cpu(vidh->sqnum) != sqnum)
+				goto bad;
+			am->pnum[i] = pnum;
+			am->ec[i] = be64_to_cpu(ech->ec);
+		}
+
+		if (len <= 0)
+			continue;
+		if (len > ubi->leb_size)
+			len = ubi->leb_size;
+
+		err = ubi_io_read_data(ubi, buf + i * ubi->leb_size, pnum, 0,
+				       len);
+		if (err == UBI_IO_BITFLIPS)
+			bitflips = 1;
+		else if (err)
+			goto bad;
+	}
+
+	if (crc32(UBI_CRC32_INIT, buf + sizeof(struct ubi_attmap_hdr),
+		  be32_to_cpu(hdr->data_size)) !=
+	    be32_to_cpu(hdr->data_crc))
+		goto bad;
+
+	si = ubi_scan_alloc_si();
+	if (!si) {
+		si = ERR_PTR(-ENOMEM);
+		goto out_buf;
+	}
+
+	err = build_si(ubi, si, hdr, vidh);
+	if (err) {
+		ubi_scan_destroy_si(si);
+		if (err == -ENOMEM) {
+			si = ERR_PTR(err);
+			goto out_buf;
+		}
+		si = NULL;
+		goto bad;
+	}
+
+	for (i = 0; i < map_pebs; i++)
+		if (am->ec[i] > si->max_ec)
+			si->max_ec = am->ec[i];
+
+	am->peb_count = map_pebs;
+	am->valid = 1;
+	ubi->attmap = am;
+	am = NULL;
+	ubi_msg("attach map found at PEB %d, scanning skipped",
+		be32_to_cpu(hdr->pnum[0]));
+
+	/*
+	 * If there were bit-flips, drop the map now, it is written again at
+	 * the end of attaching.
+	 */
+	if (bitflips && !ubi->ro_mode) {
+		err = ubi_attmap_invalidate(ubi);
+		if (err) {
+			ubi_scan_destroy_si(si);
+			si = ERR_PTR(err);
+		}
+	}
+	goto out_buf;
+
+bad:
+	ubi_warn("bad attach map at PEB %d, scan the device", am->pnum[0]);
+out_buf:
+	vfree(buf);
+out_vidh:
+	ubi_free_vid_hdr(ubi, vidh);
+out_ech:
+	kfree(ech);
+out_am:
+	kfree(am);
+	return si;
+}
+
+/**
+ * take_peb - reserve a physical eraseblock for the attach map.
+ * @am: attach map information
+ * @seb: the physical eraseblock to reserve
+ */
+static void take_peb(struct ubi_attmap *am, struct ubi_scan_leb *seb)
+{
+	am->pnum[am->peb_count] = seb->pnum;
+	am->ec[am->peb_count] = seb->ec;
+	am->peb_count += 1;
+	list_del(&seb->u.list);
+	kfree(seb);
+}
+
+/**
+ * least_worn - find the candidate PEB with the lowest erase counter.
+ * @lists: lists of candidate physical eraseblocks
+ * @count: count of lists
+ * @max_pnum: only consider physical eraseblocks below this number
+ */
+static struct ubi_scan_leb *least_worn(struct list_head **lists, int count,
+				       int max_pnum)
+{
+	int i;
+	struct ubi_scan_leb *seb, *best = NULL;
+
+	for (i = 0; i < count; i++)
+		list_for_each_entry(seb, lists[i], u.list)
+			if (seb->pnum < max_pnum &&
+			    (!best || seb->ec < best->ec))
+				best = seb;
+
+	return best;
+}
+
+/**
+ * ubi_attmap_reserve - reserve physical eraseblocks for the attach map.
+ * @ubi: UBI device description object
+ * @si: scanning information
+ *
+ * If the device was attached by means of the attach map, this function just
+ * accounts its physical eraseblocks. Otherwise it takes the least worn of
+ * the physical eraseblocks of a stale attach map, the free and the not yet
+ * erased ones for the new map and schedules the unneeded stale ones for
+ * erasure.
+ * No physical eraseblocks are reserved if the device is read-only or there
+ * are no spare ones. This function has to be called after the volume table
+ * was read and before the WL unit is initialized. Returns zero in case of
+ * success and %-ENOMEM if there is no memory.
+ */
+int ubi_attmap_reserve(struct ubi_device *ubi, struct ubi_scan_info *si)
+{
+	int i, need, spare, found = 0;
+	struct ubi_attmap *am = ubi->attmap;
+	struct ubi_scan_leb *seb, *tmp, *anchor;
+	struct list_head *lists[] = { &si->attmap, &si->free, &si->erase };
+
+	if (!am) {
+		am = kzalloc(sizeof(struct ubi_attmap), GFP_KERNEL);
+		if (!am)
+			return -ENOMEM;
+		ubi->attmap = am;
+
+		for (i = 0; i < ARRAY_SIZE(lists); i++)
+			list_for_each_entry(seb, lists[i], u.list)
+				found += 1;
+		anchor = least_worn(lists, ARRAY_SIZE(lists),
+				    UBI_ATTMAP_MAX_START);
+
+		/*
+		 * Leave the PEBs the WL and EBA units reserve for themselves
+		 * and the PEBs reserved for bad PEB handling alone.
+		 */
+		spare = ubi->avail_pebs - 2;
+		if (ubi->bad_allowed) {
+			ubi_calculate_reserved(ubi);
+			spare -= ubi->beb_rsvd_level;
+		}
+
+		need = attmap_pebs(ubi);
+		if (ubi->ro_mode || need > UBI_ATTMAP_MAX_PEBS)
+			need = 0;
+		else if (!anchor || found < need || spare < need) {
+			ubi_warn("no room for the attach map");
+			need = 0;
+		}
+
+		if (need) {
+			take_peb(am, anchor);
+			while (am->peb_count < need)
+				take_peb(am, least_worn(lists,
+							ARRAY_SIZE(lists),
+							ubi->peb_count));
+		}
+
+		list_for_each_entry_safe(seb, tmp, &si->attmap, u.list)
+			list_move_tail(&seb->u.list, &si->erase);
+	}
+
+	dbg_bld("%d PEBs reserved for the attach map", am->peb_count);
+	ubi->avail_pebs -= am->peb_count;
+	ubi->rsvd_pebs += am->peb_count;
+	return 0;
+}
+
+/**
+ * write_map_peb - write one attach map LEB.
+ * @ubi: UBI device description object
+ * @lnum: the attach map LEB to write
+ * @buf: LEB data
+ * @len: how many bytes of data to write
+ * @sqnum: sequence number of the attach map
+ * @ech: an EC header buffer
+ * @vidh: a VID header buffer
+ */
+static int write_map_peb(struct ubi_device *ubi, int lnum, const void *buf,
+			 int len, unsigned long long sqnum,
+			 struct ubi_ec_hdr *ech, struct ubi_vid_hdr *vidh)
+{
+	int err;
+	struct ubi_attmap *am = ubi->attmap;
+	int pnum = am->pnum[lnum];
+
+	err = ubi_io_sync_erase(ubi, pnum, 0);
+	if (err < 0)
+		return err;
+
+	am->ec[lnum] += err;
+	if (am->ec[lnum] > UBI_MAX_ERASECOUNTER)
+		return -EINVAL;
+
+	ech->ec = cpu_to_be64(am->ec[lnum]);
+	err = ubi_io_write_ec_hdr(ubi, pnum, ech);
+	if (err)
+		return err;
+
+	memset(vidh, 0, sizeof(struct ubi_vid_hdr));
+	vidh->vol_type = UBI_ATTMAP_VOLUME_TYPE;
+	vidh->compat = UBI_ATTMAP_VOLUME_COMPAT;
+	vidh->vol_id = cpu_to_be32(UBI_ATTMAP_VOLUME_ID);
+	vidh->lnum = cpu_to_be32(lnum);
+	vidh->sqnum = cpu_to_be64(sqnum);
+	err = ubi_io_write_vid_hdr(ubi, pnum, vidh);
+	if (err || len <= 0)
+		return err;
+
+	return ubi_io_write_data(ubi, buf, pnum, 0, ALIGN(len, ubi->min_io_size));
+}
+
+/**
+ * ubi_attmap_write - write the attach map.
+ * @ubi: UBI device description object
+ *
+ * This function writes the attach map unless the one on the flash is still
+ * valid. Failures are not fatal, the next attach just has to scan the device,
+ * but the attach map is disabled until the device is detached.
+ */
+void ubi_attmap_write(struct ubi_device *ubi)
+{
+	int i, err, pnum, size, vol_count = 0;
+	unsigned long long sqnum;
+	struct ubi_attmap *am = ubi->attmap;
+	struct ubi_attmap_hdr *hdr;
+	struct ubi_attmap_vol *vols;
+	struct ubi_attmap_peb *pebs;
+	struct ubi_ec_hdr *ech;
+	struct ubi_vid_hdr *vidh;
+	void *buf;
+
+	if (!am || am->valid || !am->peb_count || ubi->ro_mode)
+		return;
+
+	/* Pending erasures are not described by the attach map */
+	err = ubi_wl_flush(ubi);
+	if (err)
+		goto out;
+
+	err = -ENOMEM;
+	buf = vmalloc(am->peb_count * ubi->leb_size);
+	if (!buf)
+		goto out;
+
+	ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
+	if (!ech)
+		goto out_buf;
+
+	vidh = ubi_zalloc_vid_hdr(ubi, GFP_KERNEL);
+	if (!vidh)
+		goto out_ech;
+
+	memset(buf, 0xFF, am->peb_count * ubi->leb_size);
+	hdr = buf;
+	memset(hdr, 0, sizeof(struct ubi_attmap_hdr));
+
+	vols = (void *)(hdr + 1);
+	for (i = 0; i < ubi->vtbl_slots + UBI_INT_VOL_COUNT; i++) {
+		struct ubi_volume *vol = ubi->volumes[i];
+		struct ubi_attmap_vol *v = &vols[vol_count];
+
+		if (!vol)
+			continue;
+
+		memset(v, 0, sizeof(struct ubi_attmap_vol));
+		v->vol_id = cpu_to_be32(vol->vol_id);
+		v->data_pad = cpu_to_be32(vol->data_pad);
+		if (vol->vol_type == UBI_DYNAMIC_VOLUME)
+			v->vol_type = UBI_VID_DYNAMIC;
+		else {
+			v->vol_type = UBI_VID_STATIC;
+			v->used_ebs = cpu_to_be32(vol->used_ebs);
+			v->last_data_size = cpu_to_be32(vol->last_eb_bytes);
+		}
+		if (vol->vol_id == UBI_LAYOUT_VOLUME_ID)
+			v->compat = UBI_LAYOUT_VOLUME_COMPAT;
+		vol_count += 1;
+	}
+
+	/*
+	 * After flushing, the WL unit knows about used and free PEBs only, and
+	 * the used ones are those the EBA tables point to.
+	 */
+	pebs = (void *)(vols + vol_count);
+	for (pnum = 0; pnum < ubi->peb_count; pnum++) {
+		struct ubi_wl_entry *e = ubi->lookuptbl[pnum];
+
+		pebs[pnum].ec = cpu_to_be32(e ? e->ec : 0);
+		pebs[pnum].vol_id = cpu_to_be32(e ? UBI_ATTMAP_PEB_FREE :
+						    UBI_ATTMAP_PEB_UNUSED);
+		pebs[pnum].lnum = 0;
+	}
+
+	for (i = 0; i < ubi->vtbl_slots + UBI_INT_VOL_COUNT; i++) {
+		struct ubi_volume *vol = ubi->volumes[i];
+		int lnum;
+
+		if (!vol)
+			continue;
+
+		for (lnum = 0; lnum < vol->reserved_pebs; lnum++) {
+			pnum = vol->eba_tbl[lnum];
+			if (pnum < 0)
+				continue;
+			pebs[pnum].vol_id = cpu_to_be32(vol->vol_id);
+			pebs[pnum].lnum = cpu_to_be32(lnum);
+		}
+	}
+
+	spin_lock(&ubi->ltree_lock);
+	sqnum = ubi->global_sqnum++;
+	spin_unlock(&ubi->ltree_lock);
+
+	size = attmap_size(ubi, vol_count);
+	hdr->magic = cpu_to_be32(UBI_ATTMAP_MAGIC);
+	hdr->version = UBI_ATTMAP_VERSION;
+	hdr->peb_count = cpu_to_be32(ubi->peb_count);
+	hdr->vol_count = cpu_to_be32(vol_count);
+	hdr->bad_peb_count = cpu_to_be32(ubi->bad_peb_count);
+	hdr->map_pebs = cpu_to_be32(am->peb_count);
+	hdr->data_size = cpu_to_be32(size - sizeof(struct ubi_attmap_hdr));
+	hdr->data_crc = cpu_to_be32(crc32(UBI_CRC32_INIT, vols,
+					  size - sizeof(struct ubi_attmap_hdr)));
+	hdr->sqnum = cpu_to_be64(ubi->global_sqnum);
+	for (i = 0; i < am->peb_count; i++)
+		hdr->pnum[i] = cpu_to_be32(am->pnum[i]);
+	hdr->hdr_crc = cpu_to_be32(crc32(UBI_CRC32_INIT, hdr,
+					 UBI_ATTMAP_HDR_SIZE_CRC));
+
+	/* The anchor goes last, so a half-written map is never found */
+	for (i = am->peb_count - 1; i >= 0; i--) {
+		err = write_map_peb(ubi, i, buf + i * ubi->leb_size,
+				    min(size - i * ubi->leb_size, ubi->leb_size),
+				    sqnum, ech, vidh);
+		if (err)
+			break;
+	}
+
+	if (!err) {
+		am->valid = 1;
+		dbg_msg("attach map written, anchor at PEB %d", am->pnum[0]);
+	}
+
+	ubi_free_vid_hdr(ubi, vidh);
+out_ech:
+	kfree(ech);
+out_buf:
+	vfree(buf);
+out:
+	if (err) {
+		ubi_warn("cannot write attach map, error %d", err);
+		am->peb_count = 0;
+	}
+}
+
+/**
+ * ubi_attmap_invalidate - invalidate the attach map.
+ * @ubi: UBI device description object
+ *
+ * This function has to be called before the flash is changed. It erases the
+ * attach map anchor if the map is valid. Returns zero in case of success and
+ * a negative error code in case of failure, in which case the flash must not
+ * be changed.
+ */
+int ubi_attmap_invalidate(struct ubi_device *ubi)
+{
+	int err, pnum;
+	struct ubi_attmap *am = ubi->attmap;
+	struct ubi_ec_hdr *ech;
+
+	if (!am || !am->valid)
+		return 0;
+
+	ech = kzalloc(ubi->ec_hdr_alsize, GFP_NOFS);
+	if (!ech)
+		return -ENOMEM;
+
+	/* Erasing the anchor brings us here again */
+	am->valid = 0;
+	pnum = am->pnum[0];
+	dbg_msg("invalidate attach map, anchor at PEB %d", pnum);
+
+	err = ubi_io_sync_erase(ubi, pnum, 0);
+	if (err < 0) {
+		ubi_err("cannot erase attach map anchor PEB %d, error %d",
+			pnum, err);
+		am->valid = 1;
+		goto out_free;
+	}
+
+	/* The map is gone anyway, so just complain if this fails */
+	am->ec[0] += err;
+	ech->ec = cpu_to_be64(am->ec[0]);
+	err = ubi_io_write_ec_hdr(ubi, pnum, ech);
+	if (err)
+		ubi_warn("cannot write EC header to PEB %d, error %d",
+			 pnum, err);
+	err = 0;
+
+out_free:
+	kfree(ech);
+	return err;
+}
+
+/**
+ * ubi_attmap_close - free attach map information.
+ * @ubi: UBI device description object
+ */
+void ubi_attmap_close(struct ubi_device *ubi)
+{
+	kfree(ubi->attmap);
+	ubi->attmap = NULL;
+}
@@ -453,17 +453,18 @@ static void uif_close(struct ubi_device *ubi)
  * This function returns zero in case of success and a negative error code in
  * case of failure.
  *
- * Note, currently this is the only method to attach UBI devices. Hopefully in
- * the future we'll have more scalable attaching methods and avoid full media
- * scanning. But even in this case scanning will be needed as a fall-back
- * attaching method if there are some on-flash table corruptions.
+ * Note, if the attach map is enabled, the scanning information is built from
+ * the attach map when there is a valid one, and full media scanning is only
+ * used as a fall-back.
  */
 static int attach_by_scanning(struct ubi_device *ubi)
 {
 	int err;
 	struct ubi_scan_info *si;
 
-	si = ubi_scan(ubi);
+	si = ubi_attmap_scan(ubi);
+	if (!si)
+		si = ubi_scan(ubi);
 	if (IS_ERR(si))
 		return PTR_ERR(si);
 
@@ -476,6 +477,10 @@ static int attach_by_scanning(struct ubi_device *ubi)
 	if (err)
 		goto out_si;
 
+	err = ubi_attmap_reserve(ubi, si);
+	if (err)
+		goto out_vtbl;
+
 	err = ubi_wl_init_scan(ubi, si);
 	if (err)
 		goto out_vtbl;
@@ -816,6 +821,9 @@ int ubi_attach_mtd_dev(struct mtd_info *mtd, int ubi_num, int vid_hdr_offset)
 			goto out_detach;
 	}
 
+	/* Make the next attach fast, unless the attach map is up to date */
+	ubi_attmap_write(ubi);
+
 	err = uif_init(ubi);
 	if (err)
 		goto out_detach;
@@ -865,6 +873,7 @@ out_free:
 #ifdef CONFIG_MTD_UBI_DEBUG
 	vfree(ubi->dbg_peb_buf);
 #endif
+	ubi_attmap_close(ubi);
 	kfree(ubi);
 	return err;
 }
@@ -918,6 +927,9 @@ int ubi_detach_mtd_dev(int ubi_num, int anyway)
 	if (ubi->bgt_thread)
 		kthread_stop(ubi->bgt_thread);
 
+	ubi_attmap_write(ubi);
+	ubi_attmap_close(ubi);
+
 	uif_close(ubi);
 	ubi_eba_close(ubi);
 	ubi_wl_close(ubi);
@@ -236,6 +236,11 @@ int ubi_io_write(struct ubi_device *ubi, const void *buf, int pnum, int offset,
 		return -EROFS;
 	}
 
+	/* The attach map must not describe the flash after it was changed */
+	err = ubi_attmap_invalidate(ubi);
+	if (err)
+		return err;
+
 	/* The below has to be compiled out if paranoid checks are disabled */
 
 	err = paranoid_check_not_bad(ubi, pnum);
@@ -486,6 +491,10 @@ int ubi_io_sync_erase(struct ubi_device *ubi, int pnum, int torture)
 		return -EROFS;
 	}
 
+	err = ubi_attmap_invalidate(ubi);
+	if (err)
+		return err;
+
 	if (torture) {
 		ret = torture_peb(ubi, pnum);
 		if (ret < 0)
@@ -83,6 +83,10 @@ static int add_to_list(struct ubi_scan_info *si, int pnum, int ec,
 		dbg_bld("add to corrupted: PEB %d, EC %d", pnum, ec);
 	else if (list == &si->alien)
 		dbg_bld("add to alien: PEB %d, EC %d", pnum, ec);
+#ifdef CONFIG_MTD_UBI_ATTACH_MAP
+	else if (list == &si->attmap)
+		dbg_bld("add to attach map: PEB %d, EC %d", pnum, ec);
+#endif
 	else
 		BUG();
 
@@ -842,6 +846,18 @@ static int process_eb(struct ubi_device *ubi, struct ubi_scan_info *si, int pnum
 	}
 
 	vol_id = be32_to_cpu(vidh->vol_id);
+#ifdef CONFIG_MTD_UBI_ATTACH_MAP
+	if (vol_id == UBI_ATTMAP_VOLUME_ID) {
+		/*
+		 * We are scanning, so this is a stale attach map. Keep its
+		 * physical eraseblocks aside, they are re-used for the new one.
+		 */
+		err = add_to_list(si, pnum, ec, &si->attmap);
+		if (err)
+			return err;
+		goto adjust_mean_ec;
+	}
+#endif
 	if (vol_id > UBI_MAX_VOLUMES && vol_id != UBI_LAYOUT_VOLUME_ID) {
 		int lnum = be32_to_cpu(vidh->lnum);
 
@@ -896,6 +912,32 @@ adjust_mean_ec:
 	return 0;
 }
 
+/**
+ * ubi_scan_alloc_si - allocate empty scanning information.
+ *
+ * This function returns a pointer to the allocated object in case of success
+ * and %NULL if there is no memory.
+ */
+struct ubi_scan_info *ubi_scan_alloc_si(void)
+{
+	struct ubi_scan_info *si;
+
+	si = kzalloc(sizeof(struct ubi_scan_info), GFP_KERNEL);
+	if (!si)
+		return NULL;
+
+	INIT_LIST_HEAD(&si->corr);
+	INIT_LIST_HEAD(&si->free);
+	INIT_LIST_HEAD(&si->erase);
+	INIT_LIST_HEAD(&si->alien);
+#ifdef CONFIG_MTD_UBI_ATTACH_MAP
+	INIT_LIST_HEAD(&si->attmap);
+#endif
+	si->volumes = RB_ROOT;
+	si->is_empty = 1;
+	return si;
+}
+
 /**
  * ubi_scan - scan an MTD device.
  * @ubi: UBI device description object
@@ -911,17 +953,10 @@ struct ubi_scan_info *ubi_scan(struct ubi_device *ubi)
 	struct ubi_scan_leb *seb;
 	struct ubi_scan_info *si;
 
-	si = kzalloc(sizeof(struct ubi_scan_info), GFP_KERNEL);
+	si = ubi_scan_alloc_si();
 	if (!si)
 		return ERR_PTR(-ENOMEM);
 
-	INIT_LIST_HEAD(&si->corr);
-	INIT_LIST_HEAD(&si->free);
-	INIT_LIST_HEAD(&si->erase);
-	INIT_LIST_HEAD(&si->alien);
-	si->volumes = RB_ROOT;
-	si->is_empty = 1;
-
 	err = -ENOMEM;
 	ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
 	if (!ech)
@@ -974,6 +1009,12 @@ struct ubi_scan_info *ubi_scan(struct ubi_device *ubi)
 		if (seb->ec == UBI_SCAN_UNKNOWN_EC)
 			seb->ec = si->mean_ec;
 
+#ifdef CONFIG_MTD_UBI_ATTACH_MAP
+	list_for_each_entry(seb, &si->attmap, u.list)
+		if (seb->ec == UBI_SCAN_UNKNOWN_EC)
+			seb->ec = si->mean_ec;
+#endif
+
 	err = paranoid_check_si(ubi, si);
 	if (err) {
 		if (err > 0)
@@ -1054,6 +1095,12 @@ void ubi_scan_destroy_si(struct ubi_scan_info *si)
 		list_del(&seb->u.list);
 		kfree(seb);
 	}
+#ifdef CONFIG_MTD_UBI_ATTACH_MAP
+	list_for_each_entry_safe(seb, seb_tmp, &si->attmap, u.list) {
+		list_del(&seb->u.list);
+		kfree(seb);
+	}
+#endif
 
 	/* Destroy the volume RB-tree */
 	rb = si->volumes.rb_node;
@@ -1324,6 +1371,11 @@ static int paranoid_check_si(struct ubi_device *ubi, struct ubi_scan_info *si)
 	list_for_each_entry(seb, &si->alien, u.list)
 		buf[seb->pnum] = 1;
 
+#ifdef CONFIG_MTD_UBI_ATTACH_MAP
+	list_for_each_entry(seb, &si->attmap, u.list)
+		buf[seb->pnum] = 1;
+#endif
+
 	err = 0;
 	for (pnum = 0; pnum < ubi->peb_count; pnum++)
 		if (!buf[pnum]) {
@@ -94,6 +94,7 @@ struct ubi_scan_volume {
  * @alien: list of physical eraseblocks which should not be used by UBI (e.g.,
  * @bad_peb_count: count of bad physical eraseblocks
  * those belonging to "preserve"-compatible internal volumes)
+ * @attmap: list of physical eraseblocks belonging to a stale attach map
  * @vols_found: number of volumes found during scanning
  * @highest_vol_id: highest volume ID
  * @alien_peb_count: count of physical eraseblocks in the @alien list
@@ -115,6 +116,9 @@ struct ubi_scan_info {
 	struct list_head free;
 	struct list_head erase;
 	struct list_head alien;
+#ifdef CONFIG_MTD_UBI_ATTACH_MAP
+	struct list_head attmap;
+#endif
 	int bad_peb_count;
 	int vols_found;
 	int highest_vol_id;
@@ -159,6 +163,7 @@ struct ubi_scan_leb *ubi_scan_get_free_peb(struct ubi_device *ubi,
 					   struct ubi_scan_info *si);
 int ubi_scan_erase_peb(struct ubi_device *ubi, const struct ubi_scan_info *si,
 		       int pnum, int ec);
+struct ubi_scan_info *ubi_scan_alloc_si(void);
 struct ubi_scan_info *ubi_scan(struct ubi_device *ubi);
 void ubi_scan_destroy_si(struct ubi_scan_info *si);
 
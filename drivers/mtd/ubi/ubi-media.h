@@ -306,6 +306,107 @@ struct ubi_vid_hdr {
 #define UBI_LAYOUT_VOLUME_NAME   "layout volume"
 #define UBI_LAYOUT_VOLUME_COMPAT UBI_COMPAT_REJECT
 
+/*
+ * The attach map volume holds a snapshot of the PEB to LEB mapping and the
+ * erase counters which allows to attach without scanning the whole MTD
+ * device. It is "delete"-compatible, so UBI implementations which do not know
+ * about it simply drop it, which also makes sure a stale map is never used.
+ */
+#define UBI_ATTMAP_VOLUME_ID     (UBI_INTERNAL_VOL_START + 16)
+#define UBI_ATTMAP_VOLUME_TYPE   UBI_VID_DYNAMIC
+#define UBI_ATTMAP_VOLUME_COMPAT UBI_COMPAT_DELETE
+
+/* The attach map header magic number ("UBIM") */
+#define UBI_ATTMAP_MAGIC 0x5542494D
+
+/* The attach map format version */
+#define UBI_ATTMAP_VERSION 1
+
+/* The anchor (LEB 0) of the attach map is one of the first 64 PEBs */
+#define UBI_ATTMAP_MAX_START 64
+
+/* The maximum number of PEBs an attach map may occupy */
+#define UBI_ATTMAP_MAX_PEBS 16
+
+/* Special @vol_id values of &struct ubi_attmap_peb */
+#define UBI_ATTMAP_PEB_FREE   0xFFFFFFFF
+#define UBI_ATTMAP_PEB_UNUSED 0xFFFFFFFE
+
+/**
+ * struct ubi_attmap_hdr - attach map header.
+ * @magic: attach map header magic number (%UBI_ATTMAP_MAGIC)
+ * @version: attach map format version (%UBI_ATTMAP_VERSION)
+ * @padding1: reserved for future, zeroes
+ * @peb_count: count of physical eraseblocks on the MTD device
+ * @vol_count: count of &struct ubi_attmap_vol records
+ * @bad_peb_count: count of bad physical eraseblocks
+ * @map_pebs: count of physical eraseblocks the attach map occupies
+ * @data_size: size of the data following this header
+ * @data_crc: CRC32 checksum of the data following this header
+ * @sqnum: sequence number all data on the media is older than
+ * @pnum: physical eraseblocks containing attach map LEBs 0 to @map_pebs - 1
+ * @padding2: reserved for future, zeroes
+ * @hdr_crc: attach map header CRC checksum
+ *
+ * The attach map is stored in the logical eraseblocks of the attach map
+ * volume, which are just concatenated. The header is followed by @vol_count
+ * &struct ubi_attmap_vol records and then by @peb_count &struct ubi_attmap_peb
+ * records, one for each physical eraseblock.
+ */
+struct ubi_attmap_hdr {
+	__be32  magic;
+	__u8    version;
+	__u8    padding1[3];
+	__be32  peb_count;
+	__be32  vol_count;
+	__be32  bad_peb_count;
+	__be32  map_pebs;
+	__be32  data_size;
+	__be32  data_crc;
+	__be64  sqnum;
+	__be32  pnum[UBI_ATTMAP_MAX_PEBS];
+	__u8    padding2[20];
+	__be32  hdr_crc;
+} __attribute__ ((packed));
+
+/* Size of the attach map header without the ending CRC */
+#define UBI_ATTMAP_HDR_SIZE_CRC (sizeof(struct ubi_attmap_hdr) - sizeof(__be32))
+
+/**
+ * struct ubi_attmap_vol - attach map volume record.
+ * @vol_id: volume ID
+ * @used_ebs: number of used logical eraseblocks (static volumes only)
+ * @data_pad: how many bytes at the end of logical eraseblocks are not used
+ * @last_data_size: amount of data in the last used logical eraseblock (static
+ *                  volumes only)
+ * @vol_type: volume type (%UBI_VID_DYNAMIC or %UBI_VID_STATIC)
+ * @compat: compatibility flags of this volume
+ * @padding: reserved for future, zeroes
+ */
+struct ubi_attmap_vol {
+	__be32  vol_id;
+	__be32  used_ebs;
+	__be32  data_pad;
+	__be32  last_data_size;
+	__u8    vol_type;
+	__u8    compat;
+	__u8    padding[2];
+} __attribute__ ((packed));
+
+/**
+ * struct ubi_attmap_peb - attach map physical eraseblock record.
+ * @ec: erase counter
+ * @vol_id: ID of the volume the physical eraseblock belongs to,
+ *          %UBI_ATTMAP_PEB_FREE if it is free or %UBI_ATTMAP_PEB_UNUSED if it
+ *          is bad, belongs to the attach map or is not used by UBI otherwise
+ * @lnum: logical eraseblock number
+ */
+struct ubi_attmap_peb {
+	__be32  ec;
+	__be32  vol_id;
+	__be32  lnum;
+} __attribute__ ((packed));
+
 /* The maximum number of volumes per one UBI device */
 #define UBI_MAX_VOLUMES 128
 
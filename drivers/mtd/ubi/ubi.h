@@ -256,6 +256,21 @@ struct ubi_volume_desc {
 
 struct ubi_wl_entry;
 
+/**
+ * struct ubi_attmap - in-RAM attach map information.
+ * @pnum: physical eraseblocks reserved for the attach map, the anchor first
+ * @ec: erase counters of the @pnum physical eraseblocks
+ * @peb_count: count of reserved physical eraseblocks
+ * @valid: non-zero if the attach map on the media describes the current state
+ *         of the UBI device
+ */
+struct ubi_attmap {
+	int pnum[UBI_ATTMAP_MAX_PEBS];
+	int ec[UBI_ATTMAP_MAX_PEBS];
+	int peb_count;
+	int valid;
+};
+
 /**
  * struct ubi_device - UBI device description structure
  * @dev: UBI device object to use the the Linux device model
@@ -340,6 +355,7 @@ struct ubi_wl_entry;
  * @peb_buf1: a buffer of PEB size used for different purposes
  * @peb_buf2: another buffer of PEB size used for different purposes
  * @buf_mutex: proptects @peb_buf1 and @peb_buf2
+ * @attmap: attach map information
  * @dbg_peb_buf: buffer of PEB size used for debugging
  * @dbg_buf_mutex: proptects @dbg_peb_buf
  */
@@ -420,6 +436,9 @@ struct ubi_device {
 	void *peb_buf2;
 	struct mutex buf_mutex;
 	struct mutex ckvol_mutex;
+#ifdef CONFIG_MTD_UBI_ATTACH_MAP
+	struct ubi_attmap *attmap;
+#endif
 #ifdef CONFIG_MTD_UBI_DEBUG
 	void *dbg_peb_buf;
 	struct mutex dbg_buf_mutex;
@@ -514,6 +533,21 @@ int ubi_io_read_vid_hdr(struct ubi_device *ubi, int pnum,
 int ubi_io_write_vid_hdr(struct ubi_device *ubi, int pnum,
 			 struct ubi_vid_hdr *vid_hdr);
 
+/* attmap.c */
+#ifdef CONFIG_MTD_UBI_ATTACH_MAP
+struct ubi_scan_info *ubi_attmap_scan(struct ubi_device *ubi);
+int ubi_attmap_reserve(struct ubi_device *ubi, struct ubi_scan_info *si);
+void ubi_attmap_write(struct ubi_device *ubi);
+int ubi_attmap_invalidate(struct ubi_device *ubi);
+void ubi_attmap_close(struct ubi_device *ubi);
+#else
+#define ubi_attmap_scan(ubi) NULL
+#define ubi_attmap_reserve(ubi, si) 0
+#define ubi_attmap_write(ubi)
+#define ubi_attmap_invalidate(ubi) 0
+#define ubi_attmap_close(ubi)
+#endif
+
 /* build.c */
 int ubi_attach_mtd_dev(struct mtd_info *mtd, int ubi_num, int vid_hdr_offset);
 int ubi_detach_mtd_dev(int ubi_num, int anyway);
@@ -107,6 +107,20 @@ static int			emac_rx_queue_active = 0;
 /* Receive packet buffers */
 static unsigned char		emac_rx_buffers[EMAC_MAX_RX_BUFFERS * (EMAC_MAX_ETHERNET_PKT_SIZE + EMAC_PKT_ALIGN)];
 
+#define EMAC_RX_BUFFER(n)	(&emac_rx_buffers[(n) * (EMAC_MAX_ETHERNET_PKT_SIZE + EMAC_PKT_ALIGN)])
+
+#ifdef CONFIG_NET_DIRECT_RX
+/*
+ * Direct receive: while a protocol announces its payloads, even RX
+ * descriptors get only the frame header into their own buffer and odd
+ * ones point at the payload destination; CPPI continues a frame which
+ * does not fit into one buffer in the next descriptor.
+ */
+static u_int16_t		emac_rx_armed_len[EMAC_MAX_RX_BUFFERS];
+/* No payload buffer may be handed out below this again */
+static uchar			*emac_rx_direct_next;
+#endif
+
 /* PHY address for a discovered PHY (0xff - not found) */
 static volatile u_int8_t	active_phy_addr = 0xff;
 
@@ -407,11 +421,17 @@ static int davinci_eth_open(struct eth_device *dev, bd_t *bis)
 	emac_rx_active_head = emac_rx_desc;
 	for (cnt = 0; cnt < EMAC_MAX_RX_BUFFERS; cnt++) {
 		rx_desc->next = BD_TO_HW((u_int32_t)(rx_desc + 1));
-		rx_desc->buffer = &emac_rx_buffers[cnt * (EMAC_MAX_ETHERNET_PKT_SIZE + EMAC_PKT_ALIGN)];
+		rx_desc->buffer = EMAC_RX_BUFFER(cnt);
 		rx_desc->buff_off_len = EMAC_MAX_ETHERNET_PKT_SIZE;
 		rx_desc->pkt_flag_len = EMAC_CPPI_OWNERSHIP_BIT;
 		rx_desc++;
+#ifdef CONFIG_NET_DIRECT_RX
+		emac_rx_armed_len[cnt] = EMAC_MAX_ETHERNET_PKT_SIZE;
+#endif
 	}
+#ifdef CONFIG_NET_DIRECT_RX
+	emac_rx_direct_next = NULL;
+#endif
 
 	/* Finalize the rx desc list */
 	rx_desc--;
@@ -592,22 +612,156 @@ static int davinci_eth_send_packet (struct eth_device *dev,
 	return (ret_status);
 }
 
+#ifdef CONFIG_NET_DIRECT_RX
+/*
+ * Point a recycled RX descriptor at its buffer.  A payload buffer is
+ * predicted for the n-th frame from now, n counting every descriptor
+ * still queued as a frame of its own unless it was armed short, in
+ * which case any frame longer than the header takes two of them.
+ */
+static void davinci_eth_rx_arm(volatile emac_desc *desc)
+{
+	volatile emac_desc *queued;
+	int idx = desc - emac_rx_desc;
+	int nfull = 0, nsplit = 0, n;
+	u_int8_t *buf = EMAC_RX_BUFFER(idx);
+	int len = EMAC_MAX_ETHERNET_PKT_SIZE;
+	uchar *addr;
+
+	if (NetDirectRx.addr && !(idx & 1)) {
+		len = NetDirectRx.hdr_len;
+	} else if (NetDirectRx.addr) {
+		for (queued = emac_rx_active_head; queued;
+		     queued = (volatile emac_desc *)HW_TO_BD(queued->next)) {
+			if (emac_rx_armed_len[queued - emac_rx_desc] ==
+			    EMAC_MAX_ETHERNET_PKT_SIZE)
+				nfull++;
+			else
+				nsplit++;
+		}
+
+		n = nfull + nsplit / 2;
+		addr = NetDirectRxAddr(n);
+		while (addr && addr < emac_rx_direct_next)
+			addr = NetDirectRxAddr(++n);
+		if (addr) {
+			buf = addr;
+			len = NetDirectRx.len;
+			emac_rx_direct_next = addr + len;
+		}
+	}
+
+	desc->buffer = buf;
+	desc->buff_off_len = len;
+	emac_rx_armed_len[idx] = len;
+}
+
+/*
+ * Pass on a frame: header and payload buffer go to NetReceiveSplit(),
+ * anything else is gathered in the own buffer of its first descriptor.
+ */
+static int davinci_eth_rx_frame(volatile emac_desc *first,
+				volatile emac_desc *last)
+{
+	volatile emac_desc *desc = first;
+	u_int8_t *buf = EMAC_RX_BUFFER(first - emac_rx_desc);
+	int len = 0, n;
+
+	if ((volatile emac_desc *)HW_TO_BD(first->next) == last) {
+		NetReceiveSplit(first->buffer, first->buff_off_len & 0xffff,
+				last->buffer, last->buff_off_len & 0xffff);
+		return first->pkt_flag_len & 0xffff;
+	}
+
+	for (;;) {
+		n = desc->buff_off_len & 0xffff;
+		if (len + n > EMAC_MAX_ETHERNET_PKT_SIZE) {
+			printf ("WARN: emac_rcv_pkt: Frame too long\n");
+			return -1;
+		}
+		if (desc->buffer != buf + len)
+			memcpy(buf + len, desc->buffer, n);
+		len += n;
+		if (desc == last)
+			break;
+		desc = (volatile emac_desc *)HW_TO_BD(desc->next);
+	}
+
+	NetReceive(buf, len);
+	return len;
+}
+#endif
+
+/* Put a processed RX descriptor back at the end of the queue */
+static void davinci_eth_rx_recycle(volatile emac_desc *rx_curr_desc)
+{
+	volatile emac_desc *curr_desc = rx_curr_desc;
+	volatile emac_desc *tail_desc;
+	int status;
+
+#ifdef CONFIG_NET_DIRECT_RX
+	davinci_eth_rx_arm(rx_curr_desc);
+#else
+	rx_curr_desc->buff_off_len = EMAC_MAX_ETHERNET_PKT_SIZE;
+#endif
+	rx_curr_desc->pkt_flag_len = EMAC_CPPI_OWNERSHIP_BIT;
+	rx_curr_desc->next = 0;
+
+	if (emac_rx_active_head == 0) {
+		printf ("INFO: emac_rcv_pkt: active queue head = 0\n");
+		emac_rx_active_head = curr_desc;
+		emac_rx_active_tail = curr_desc;
+		if (emac_rx_queue_active != 0) {
+			writel((BD_TO_HW((unsigned int) emac_rx_active_head)),
+			       &adap_emac->RX0HDP);
+			printf ("INFO: emac_rcv_pkt: active queue head = 0, HDP fired\n");
+			emac_rx_queue_active = 1;
+		}
+	} else {
+		tail_desc = emac_rx_active_tail;
+		emac_rx_active_tail = curr_desc;
+		tail_desc->next = BD_TO_HW((unsigned int) curr_desc);
+		status = tail_desc->pkt_flag_len;
+		if (status & EMAC_CPPI_EOQ_BIT) {
+			writel((BD_TO_HW((unsigned int) curr_desc)),
+			       &adap_emac->RX0HDP);
+			status &= ~EMAC_CPPI_EOQ_BIT;
+			tail_desc->pkt_flag_len = status;
+		}
+	}
+}
+
 /*
  * This function handles receipt of a packet from the network
  */
 static int davinci_eth_rcv_packet (struct eth_device *dev)
 {
 	volatile emac_desc *rx_curr_desc;
-	volatile emac_desc *curr_desc;
-	volatile emac_desc *tail_desc;
+	volatile emac_desc *rx_last_desc;
+	volatile emac_desc *next_desc;
 	int status, ret = -1;
 
 	rx_curr_desc = emac_rx_active_head;
 	status = rx_curr_desc->pkt_flag_len;
 	if ((rx_curr_desc) && ((status & EMAC_CPPI_OWNERSHIP_BIT) == 0)) {
+		/* A frame may continue in the following descriptors */
+		rx_last_desc = rx_curr_desc;
+		while (!(rx_last_desc->pkt_flag_len & EMAC_CPPI_EOP_BIT) &&
+		       rx_last_desc->next)
+			rx_last_desc = (volatile emac_desc *)
+					(HW_TO_BD(rx_last_desc->next));
+
 		if (status & EMAC_CPPI_RX_ERROR_FRAME) {
 			/* Error in packet - discard it and requeue desc */
 			printf ("WARN: emac_rcv_pkt: Error in packet\n");
+#ifdef CONFIG_NET_DIRECT_RX
+		} else if (rx_last_desc != rx_curr_desc) {
+			ret = davinci_eth_rx_frame(rx_curr_desc, rx_last_desc);
+		} else if (rx_curr_desc->buffer !=
+			   EMAC_RX_BUFFER(rx_curr_desc - emac_rx_desc)) {
+			/* a whole frame in a payload buffer */
+			ret = davinci_eth_rx_frame(rx_curr_desc, rx_last_desc);
+#endif
 		} else {
 			NetReceive (rx_curr_desc->buffer,
 				    (rx_curr_desc->buff_off_len & 0xffff));
@@ -615,12 +769,11 @@ static int davinci_eth_rcv_packet (struct eth_device *dev)
 		}
 
 		/* Ack received packet descriptor */
-		writel((BD_TO_HW((unsigned int) rx_curr_desc)), &adap_emac->RX0CP);
-		curr_desc = rx_curr_desc;
+		writel((BD_TO_HW((unsigned int) rx_last_desc)), &adap_emac->RX0CP);
 		emac_rx_active_head = (volatile emac_desc *)
-					(HW_TO_BD(rx_curr_desc->next));
+					(HW_TO_BD(rx_last_desc->next));
 
-		if (status & EMAC_CPPI_EOQ_BIT) {
+		if (rx_last_desc->pkt_flag_len & EMAC_CPPI_EOQ_BIT) {
 			if (emac_rx_active_head) {
 				writel((BD_TO_HW((unsigned int) emac_rx_active_head)),
 				       &adap_emac->RX0HDP);
@@ -630,32 +783,14 @@ static int davinci_eth_rcv_packet (struct eth_device *dev)
 			}
 		}
 
-		/* Recycle RX descriptor */
-		rx_curr_desc->buff_off_len = EMAC_MAX_ETHERNET_PKT_SIZE;
-		rx_curr_desc->pkt_flag_len = EMAC_CPPI_OWNERSHIP_BIT;
-		rx_curr_desc->next = 0;
-
-		if (emac_rx_active_head == 0) {
-			printf ("INFO: emac_rcv_pkt: active queue head = 0\n");
-			emac_rx_active_head = curr_desc;
-			emac_rx_active_tail = curr_desc;
-			if (emac_rx_queue_active != 0) {
-				writel((BD_TO_HW((unsigned int) emac_rx_active_head)),
-				       &adap_emac->RX0HDP);
-				printf ("INFO: emac_rcv_pkt: active queue head = 0, HDP fired\n");
-				emac_rx_queue_active = 1;
-			}
-		} else {
-			tail_desc = emac_rx_active_tail;
-			emac_rx_active_tail = curr_desc;
-			tail_desc->next = BD_TO_HW((unsigned int) curr_desc);
-			status = tail_desc->pkt_flag_len;
-			if (status & EMAC_CPPI_EOQ_BIT) {
-				writel((BD_TO_HW((unsigned int) curr_desc)),
-				       &adap_emac->RX0HDP);
-				status &= ~EMAC_CPPI_EOQ_BIT;
-				tail_desc->pkt_flag_len = status;
-			}
+		/* Recycle RX descriptors */
+		for (;;) {
+			next_desc = (volatile emac_desc *)
+					(HW_TO_BD(rx_curr_desc->next));
+			davinci_eth_rx_recycle(rx_curr_desc);
+			if (rx_curr_desc == rx_last_desc)
+				break;
+			rx_curr_desc = next_desc;
 		}
 		return (ret);
 	}
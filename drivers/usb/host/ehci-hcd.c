@@ -141,6 +141,7 @@ static void cache_qh(struct QH *qh, int flush)
 {
 	struct qTD *qtd;
 	struct qTD *next;
+	struct qTD *alt, *last_alt = NULL;
 	static struct qTD *first_qtd;
 
 	/*
@@ -165,12 +166,18 @@ static void cache_qh(struct QH *qh, int flush)
 		qtd = first_qtd;
 
 	/*
-	 * Walk the qTD list and flush/invalidate all entries
+	 * Walk the qTD list and flush/invalidate all entries, including
+	 * the qTDs only reachable through qt_altnext (short packets)
 	 */
 	while (1) {
 		if (qtd == NULL)
 			break;
 		cache_qtd(qtd, flush);
+		alt = (struct qTD *)((u32)qtd->qt_altnext & 0xffffffe0);
+		if (alt != NULL && alt != last_alt) {
+			cache_qtd(alt, flush);
+			last_alt = alt;
+		}
 		next = (struct qTD *)((u32)qtd->qt_next & 0xffffffe0);
 		if (next == qtd)
 			break;
@@ -253,7 +260,8 @@ out:
 static void *ehci_alloc(size_t sz, size_t align)
 {
 	static struct QH qh __attribute__((aligned(32)));
-	static struct qTD td[3] __attribute__((aligned (32)));
+	static struct qTD td[CONFIG_SYS_USB_EHCI_MAX_QTD]
+		__attribute__((aligned (32)));
 	static int ntds;
 	void *p;
 
@@ -263,7 +271,7 @@ static void *ehci_alloc(size_t sz, size_t align)
 		ntds = 0;
 		break;
 	case sizeof(struct qTD):
-		if (ntds == 3) {
+		if (ntds == CONFIG_SYS_USB_EHCI_MAX_QTD) {
 			debug("out of TDs\n");
 			return NULL;
 		}
@@ -305,19 +313,39 @@ static int ehci_td_buffer(struct qTD *td, void *buf, size_t sz)
 	return 0;
 }
 
+/* Returns 1 if one of the n data qTDs at td finished with a short packet */
+static int ehci_short_td(struct qTD *td, int n)
+{
+	uint32_t token;
+
+	while (n--) {
+		token = hc32_to_cpu(((volatile struct qTD *)td)->qt_token);
+		if (token & 0x80)
+			return 0;
+		if ((token >> 16) & 0x7fff)
+			return 1;
+		td = (struct qTD *)hc32_to_cpu(td->qt_next);
+	}
+	return 0;
+}
+
 static int
 ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 		   int length, struct devrequest *req)
 {
 	struct QH *qh;
 	struct qTD *td;
+	struct qTD *data_td = NULL;
+	struct qTD *alt_td = NULL;
+	int ndata = 0;
 	volatile struct qTD *vtd;
-	unsigned long ts;
+	unsigned long ts, timeout;
 	uint32_t *tdp;
 	uint32_t endpt, token, usbsts;
 	uint32_t c, toggle;
 	uint32_t cmd;
 	int ret = 0;
+	int i;
 
 	debug("dev=%p, pipe=%lx, buffer=%p, length=%d, req=%p\n", dev, pipe,
 	      buffer, length, req);
@@ -379,39 +407,81 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 		toggle = 1;
 	}
 
-	if (length > 0 || req == NULL) {
-		td = ehci_alloc(sizeof(struct qTD), 32);
-		if (td == NULL) {
-			debug("unable to allocate DATA td\n");
-			goto fail;
-		}
-		td->qt_next = cpu_to_hc32(QT_NEXT_TERMINATE);
-		td->qt_altnext = cpu_to_hc32(QT_NEXT_TERMINATE);
-		token = (toggle << 31) |
-		    (length << 16) |
-		    ((req == NULL ? 1 : 0) << 15) |
-		    (0 << 12) |
-		    (3 << 10) |
-		    ((usb_pipein(pipe) ? 1 : 0) << 8) | (0x80 << 0);
-		td->qt_token = cpu_to_hc32(token);
-		if (ehci_td_buffer(td, buffer, length) != 0) {
-			debug("unable construct DATA td\n");
-			ehci_free(td, sizeof(*td));
+	/*
+	 * A short IN packet ends the data stage: the controller goes on at
+	 * qt_altnext, which is the status qTD of a control transfer, or an
+	 * inactive qTD that stops a bulk transfer.
+	 */
+	if (usb_pipein(pipe) && length > 0) {
+		alt_td = ehci_alloc(sizeof(struct qTD), 32);
+		if (alt_td == NULL) {
+			debug("unable to allocate ALT td\n");
 			goto fail;
 		}
-		*tdp = cpu_to_hc32((uint32_t) td);
-		tdp = &td->qt_next;
+		alt_td->qt_next = cpu_to_hc32(QT_NEXT_TERMINATE);
+		alt_td->qt_altnext = cpu_to_hc32(QT_NEXT_TERMINATE);
+	}
+
+	if (length > 0 || req == NULL) {
+		uint8_t *buf_ptr = buffer;
+		int maxpacket = usb_maxpacket(dev, pipe);
+		int left = length;
+		int xfr;
+
+		/*
+		 * A qTD covers at most five 4 KiB pages, so large buffers
+		 * are split over a chain of qTDs. Every qTD but the last
+		 * must end on a packet boundary.
+		 */
+		do {
+			xfr = 5 * 4096 - ((uint32_t)buf_ptr & 4095);
+			if (xfr >= left)
+				xfr = left;
+			else
+				xfr -= xfr % maxpacket;
+
+			td = ehci_alloc(sizeof(struct qTD), 32);
+			if (td == NULL) {
+				debug("unable to allocate DATA td\n");
+				goto fail;
+			}
+			if (data_td == NULL)
+				data_td = td;
+			ndata++;
+			td->qt_next = cpu_to_hc32(QT_NEXT_TERMINATE);
+			td->qt_altnext = cpu_to_hc32(alt_td ? (uint32_t)alt_td :
+						     QT_NEXT_TERMINATE);
+			token = (toggle << 31) |
+			    (xfr << 16) |
+			    ((req == NULL ? 1 : 0) << 15) |
+			    (0 << 12) |
+			    (3 << 10) |
+			    ((usb_pipein(pipe) ? 1 : 0) << 8) | (0x80 << 0);
+			td->qt_token = cpu_to_hc32(token);
+			if (ehci_td_buffer(td, buf_ptr, xfr) != 0) {
+				debug("unable construct DATA td\n");
+				ehci_free(td, sizeof(*td));
+				goto fail;
+			}
+			*tdp = cpu_to_hc32((uint32_t) td);
+			tdp = &td->qt_next;
+
+			toggle ^= (xfr / maxpacket) & 1;
+			buf_ptr += xfr;
+			left -= xfr;
+		} while (left > 0);
 	}
 
 	if (req != NULL) {
-		td = ehci_alloc(sizeof(struct qTD), 32);
+		td = alt_td ? alt_td : ehci_alloc(sizeof(struct qTD), 32);
 		if (td == NULL) {
 			debug("unable to allocate ACK td\n");
 			goto fail;
 		}
+		alt_td = NULL;
 		td->qt_next = cpu_to_hc32(QT_NEXT_TERMINATE);
 		td->qt_altnext = cpu_to_hc32(QT_NEXT_TERMINATE);
-		token = (toggle << 31) |
+		token = (1 << 31) |
 		    (0 << 16) |
 		    (1 << 15) |
 		    (0 << 12) |
@@ -442,7 +512,8 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 		goto fail;
 	}
 
-	/* Wait for TDs to be processed. */
+	/* Wait for TDs to be processed, allowing for 1 MB/s at least. */
+	timeout = CONFIG_SYS_HZ + (length >> 10) * CONFIG_SYS_HZ / 1000;
 	ts = get_timer(0);
 	vtd = td;
 	do {
@@ -451,7 +522,10 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 		token = hc32_to_cpu(vtd->qt_token);
 		if (!(token & 0x80))
 			break;
-	} while (get_timer(ts) < CONFIG_SYS_HZ);
+		/* a bulk transfer stops at the qTD with the short packet */
+		if (alt_td != NULL && ehci_short_td(data_td, ndata))
+			break;
+	} while (get_timer(ts) < timeout);
 
 	/* Disable async schedule. */
 	cmd = ehci_readl(&hcor->or_usbcmd);
@@ -492,7 +566,14 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 			dev->status = USB_ST_CRC_ERR;
 			break;
 		}
-		dev->act_len = length - ((token >> 16) & 0x7fff);
+		/* Subtract what is left over in each data qTD. */
+		dev->act_len = length;
+		td = data_td;
+		for (i = 0; i < ndata; i++) {
+			dev->act_len -= (hc32_to_cpu(td->qt_token) >> 16) &
+					0x7fff;
+			td = (struct qTD *)hc32_to_cpu(td->qt_next);
+		}
 	} else {
 		dev->act_len = 0;
 		debug("dev=%u, usbsts=%#x, p[1]=%#x, p[2]=%#x\n",
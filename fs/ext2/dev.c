@@ -80,10 +80,9 @@ int ext2fs_devread (int sector, int byte_offset, int byte_len, char *buf) {
 
 	if (byte_offset != 0) {
 		/* read first part which isn't aligned with start of sector */
-		if (ext2fs_block_dev_desc->
-		    block_read (ext2fs_block_dev_desc->dev,
-				part_info.start + sector, 1,
-				(unsigned long *) sec_buf) != 1) {
+		if (blkcache_read (ext2fs_block_dev_desc,
+				   part_info.start + sector, 1,
+				   (unsigned long *) sec_buf) != 1) {
 			printf (" ** ext2fs_devread() read error **\n");
 			return (0);
 		}
@@ -104,17 +103,16 @@ int ext2fs_devread (int sector, int byte_offset, int byte_len, char *buf) {
 		u8 p[SECTOR_SIZE];
 
 		block_len = SECTOR_SIZE;
-		ext2fs_block_dev_desc->block_read(ext2fs_block_dev_desc->dev,
-						  part_info.start + sector,
-						  1, (unsigned long *)p);
+		blkcache_read(ext2fs_block_dev_desc, part_info.start + sector,
+			      1, (unsigned long *)p);
 		memcpy(buf, p, byte_len);
 		return 1;
 	}
 
-	if (ext2fs_block_dev_desc->block_read (ext2fs_block_dev_desc->dev,
-					       part_info.start + sector,
-					       block_len / SECTOR_SIZE,
-					       (unsigned long *) buf) !=
+	if (blkcache_read (ext2fs_block_dev_desc,
+			   part_info.start + sector,
+			   block_len / SECTOR_SIZE,
+			   (unsigned long *) buf) !=
 	    block_len / SECTOR_SIZE) {
 		printf (" ** ext2fs_devread() read error - block\n");
 		return (0);
@@ -126,10 +124,9 @@ int ext2fs_devread (int sector, int byte_offset, int byte_len, char *buf) {
 
 	if (byte_len != 0) {
 		/* read rest of data which are not in whole sector */
-		if (ext2fs_block_dev_desc->
-		    block_read (ext2fs_block_dev_desc->dev,
-				part_info.start + sector, 1,
-				(unsigned long *) sec_buf) != 1) {
+		if (blkcache_read (ext2fs_block_dev_desc,
+				   part_info.start + sector, 1,
+				   (unsigned long *) sec_buf) != 1) {
 			printf (" ** ext2fs_devread() read error - last part\n");
 			return (0);
 		}
@@ -46,6 +46,17 @@ extern int ext2fs_devread (int sector, int byte_offset, int byte_len,
 #define	FILETYPE_DIRECTORY	2
 #define	FILETYPE_SYMLINK	7
 
+/* Features and inode flags used by ext4.  */
+#define EXT4_FEATURE_INCOMPAT_64BIT	0x0080
+#define EXT4_EXTENTS_FL			0x00080000
+#define EXT4_EXT_MAGIC			0xF30A
+/* Extents longer than this are uninitialized (read as zeroes).  */
+#define EXT4_EXT_INIT_MAX_LEN		32768
+/* Maximum depth of an extent tree.  */
+#define EXT4_EXT_MAX_DEPTH		5
+/* Size of a group descriptor without the 64bit feature.  */
+#define EXT2_MIN_DESC_SIZE		32
+
 /* Filetype information as used in inodes.  */
 #define FILETYPE_INO_MASK	0170000
 #define FILETYPE_INO_REG	0100000
@@ -101,6 +112,17 @@ struct ext2_sblock {
 	char volume_name[16];
 	char last_mounted_on[64];
 	uint32_t compression_info;
+	uint8_t prealloc_blocks;
+	uint8_t prealloc_dir_blocks;
+	uint16_t reserved_gdt_blocks;
+	uint8_t journal_uuid[16];
+	uint32_t journal_inode;
+	uint32_t journal_dev;
+	uint32_t last_orphan;
+	uint32_t hash_seed[4];
+	uint8_t default_hash_version;
+	uint8_t journal_backup_type;
+	uint16_t descriptor_size;
 };
 
 /* The ext2 blockgroup.  */
@@ -112,6 +134,11 @@ struct ext2_block_group {
 	uint16_t free_inodes;
 	uint16_t used_dir_cnt;
 	uint32_t reserved[3];
+	/* The following fields only exist with the 64bit feature.  */
+	uint32_t block_id_high;
+	uint32_t inode_id_high;
+	uint32_t inode_table_id_high;
+	uint32_t reserved_high[5];
 };
 
 /* The ext2 inode.  */
@@ -144,6 +171,30 @@ struct ext2_inode {
 	uint32_t osd2[3];
 };
 
+/* The ext4 extent tree, stored in the inode block array and in
+   index/leaf blocks.  */
+struct ext4_extent_header {
+	uint16_t magic;
+	uint16_t entries;
+	uint16_t max;
+	uint16_t depth;
+	uint32_t generation;
+};
+
+struct ext4_extent_idx {
+	uint32_t block;		/* first file block covered */
+	uint32_t leaf;		/* next level block, low 32 bits */
+	uint16_t leaf_high;
+	uint16_t unused;
+};
+
+struct ext4_extent {
+	uint32_t block;		/* first file block */
+	uint16_t len;
+	uint16_t start_high;
+	uint32_t start;		/* first disk block, low 32 bits */
+};
+
 /* The header of an ext2 directory entry.  */
 struct ext2_dirent {
 	uint32_t inode;
@@ -179,6 +230,16 @@ uint32_t *indir2_block = NULL;
 int indir2_size = 0;
 int indir2_blkno = -1;
 static unsigned int inode_size;
+static unsigned int desc_size;
+/* Extent tree nodes, one block per level.  */
+static char *ext4_nodes = NULL;
+static int ext4_nodes_size = 0;
+static uint64_t ext4_node_blkno[EXT4_EXT_MAX_DEPTH];
+/* Last extent found, so runs of file blocks are mapped in O(1).  */
+static int ext4_cache_ino = -1;
+static uint32_t ext4_cache_block;
+static uint32_t ext4_cache_len;
+static uint32_t ext4_cache_start;
 
 
 static int ext2fs_blockgroup
@@ -187,17 +248,19 @@ static int ext2fs_blockgroup
 	unsigned int blkoff;
 	unsigned int desc_per_blk;
 
-	desc_per_blk = EXT2_BLOCK_SIZE(data) / sizeof(struct ext2_block_group);
+	desc_per_blk = EXT2_BLOCK_SIZE(data) / desc_size;
 
 	blkno = __le32_to_cpu(data->sblock.first_data_block) + 1 +
 	group / desc_per_blk;
-	blkoff = (group % desc_per_blk) * sizeof(struct ext2_block_group);
+	blkoff = (group % desc_per_blk) * desc_size;
 #ifdef DEBUG
 	printf ("ext2fs read %d group descriptor (blkno %d blkoff %d)\n",
 		group, blkno, blkoff);
 #endif
+	memset (blkgrp, 0, sizeof(struct ext2_block_group));
 	return (ext2fs_devread (blkno << LOG2_EXT2_BLOCK_SIZE(data),
-		blkoff, sizeof(struct ext2_block_group), (char *)blkgrp));
+		blkoff, min(desc_size, sizeof(struct ext2_block_group)),
+		(char *)blkgrp));
 
 }
 
@@ -223,6 +286,11 @@ static int ext2fs_read_inode
 		return (0);
 	}
 
+	if (blkgrp.inode_table_id_high) {
+		printf ("** ext2fs inode table above 2^32 blocks not supported. **\n");
+		return (0);
+	}
+
 	inodes_per_block = EXT2_BLOCK_SIZE(data) / inode_size;
 
 	blkno = __le32_to_cpu (blkgrp.inode_table_id) +
@@ -250,6 +318,124 @@ void ext2fs_free_node (ext2fs_node_t node, ext2fs_node_t currroot) {
 }
 
 
+static int ext4fs_read_block (ext2fs_node_t node, int fileblock) {
+	struct ext2_data *data = node->data;
+	struct ext4_extent_header *eh;
+	struct ext4_extent *ex;
+	int blksz = EXT2_BLOCK_SIZE (data);
+	int log2_blksz = LOG2_EXT2_BLOCK_SIZE (data);
+	uint32_t block = fileblock;
+	int size = sizeof (node->inode.b);
+	int level;
+	int i;
+
+	if (ext4_cache_ino == node->ino &&
+	    block - ext4_cache_block < ext4_cache_len) {
+		return (ext4_cache_start + (block - ext4_cache_block));
+	}
+
+	if (ext4_nodes_size != blksz * EXT4_EXT_MAX_DEPTH) {
+		free (ext4_nodes);
+		ext4_nodes = malloc (blksz * EXT4_EXT_MAX_DEPTH);
+		if (ext4_nodes == NULL) {
+			ext4_nodes_size = 0;
+			printf ("** ext4fs read block malloc failed. **\n");
+			return (-1);
+		}
+		ext4_nodes_size = blksz * EXT4_EXT_MAX_DEPTH;
+		memset (ext4_node_blkno, 0, sizeof (ext4_node_blkno));
+	}
+
+	/* Walk down the index levels to the leaf covering fileblock.  */
+	eh = (struct ext4_extent_header *) &node->inode.b;
+	for (level = 0; ; level++) {
+		struct ext4_extent_idx *ix;
+		uint64_t leaf;
+		int entries = __le16_to_cpu (eh->entries);
+		int max = __le16_to_cpu (eh->max);
+
+		/* Index and leaf entries have the same size.  */
+		if (__le16_to_cpu (eh->magic) != EXT4_EXT_MAGIC ||
+		    entries > max || sizeof (*eh) +
+		    max * sizeof (struct ext4_extent) > size) {
+			printf ("** ext4fs bad extent header. **\n");
+			return (-1);
+		}
+		if (eh->depth == 0) {
+			break;
+		}
+		if (entries == 0) {
+			return (0);
+		}
+		if (level == EXT4_EXT_MAX_DEPTH) {
+			printf ("** ext4fs extent tree too deep. **\n");
+			return (-1);
+		}
+
+		ix = (struct ext4_extent_idx *) (eh + 1);
+		for (i = 1; i < entries; i++) {
+			if (__le32_to_cpu (ix[i].block) > block) {
+				break;
+			}
+		}
+		leaf = ((uint64_t) __le16_to_cpu (ix[i - 1].leaf_high) << 32) |
+			__le32_to_cpu (ix[i - 1].leaf);
+		if (leaf > (0x7fffffff >> log2_blksz)) {
+			printf ("** ext4fs block number too large. **\n");
+			return (-1);
+		}
+
+		eh = (struct ext4_extent_header *) (ext4_nodes + level * blksz);
+		size = blksz;
+		if (ext4_node_blkno[level] != leaf) {
+			ext4_node_blkno[level] = 0;
+			if (ext2fs_devread (leaf << log2_blksz, 0, blksz,
+					    (char *) eh) == 0) {
+				printf ("** ext4fs read extent block failed. **\n");
+				return (-1);
+			}
+			ext4_node_blkno[level] = leaf;
+		}
+	}
+
+	ex = (struct ext4_extent *) (eh + 1);
+	for (i = 0; i < __le16_to_cpu (eh->entries); i++) {
+		uint32_t first = __le32_to_cpu (ex[i].block);
+		uint32_t len = __le16_to_cpu (ex[i].len);
+		uint64_t start;
+
+		if (block < first) {
+			break;
+		}
+		if (len > EXT4_EXT_INIT_MAX_LEN) {
+			/* Uninitialized: allocated but reads as zeroes.  */
+			if (block - first < len - EXT4_EXT_INIT_MAX_LEN) {
+				return (0);
+			}
+			continue;
+		}
+		if (block - first >= len) {
+			continue;
+		}
+
+		start = ((uint64_t) __le16_to_cpu (ex[i].start_high) << 32) |
+			__le32_to_cpu (ex[i].start);
+		if (start + len - 1 > (0x7fffffff >> log2_blksz)) {
+			printf ("** ext4fs block number too large. **\n");
+			return (-1);
+		}
+		ext4_cache_ino = node->ino;
+		ext4_cache_block = first;
+		ext4_cache_len = len;
+		ext4_cache_start = start;
+		return (start + (block - first));
+	}
+
+	/* Not mapped: a hole.  */
+	return (0);
+}
+
+
 static int ext2fs_read_block (ext2fs_node_t node, int fileblock) {
 	struct ext2_data *data = node->data;
 	struct ext2_inode *inode = &node->inode;
@@ -258,6 +444,10 @@ static int ext2fs_read_block (ext2fs_node_t node, int fileblock) {
 	int log2_blksz = LOG2_EXT2_BLOCK_SIZE (data);
 	int status;
 
+	if (__le32_to_cpu (inode->flags) & EXT4_EXTENTS_FL) {
+		return (ext4fs_read_block (node, fileblock));
+	}
+
 	/* Direct blocks.  */
 	if (fileblock < INDIRECT_BLOCKS) {
 		blknr = __le32_to_cpu (inode->b.blocks.dir_blocks[fileblock]);
@@ -364,7 +554,7 @@ static int ext2fs_read_block (ext2fs_node_t node, int fileblock) {
 			indir2_size = blksz;
 		}
 		if ((__le32_to_cpu (indir1_block[rblock / perblock]) <<
-		     log2_blksz) != indir1_blkno) {
+		     log2_blksz) != indir2_blkno) {
 			status = ext2fs_devread (__le32_to_cpu(indir1_block[rblock / perblock]) << log2_blksz,
 						 0, blksz,
 						 (char *) indir2_block);
@@ -436,15 +626,39 @@ int ext2fs_read_file
 		   is zero filled instead.  */
 		if (blknr) {
 			int status;
+			int run = 1;
+
+			/* Read physically contiguous whole blocks in one go.  */
+			if (!skipfirst && blockend == blocksize) {
+				while (i + run < blockcnt) {
+					int next;
+
+					if (i + run == blockcnt - 1 &&
+					    (len + pos) % blocksize)
+						break;
+					next = ext2fs_read_block (node, i + run);
+					if (next < 0) {
+						return (-1);
+					}
+					if (next << log2blocksize !=
+					    blknr + (run << log2blocksize))
+						break;
+					run++;
+				}
+			}
 
-			status = ext2fs_devread (blknr, skipfirst, blockend, buf);
+			status = ext2fs_devread (blknr, skipfirst,
+						 blockend + (run - 1) * blocksize,
+						 buf);
 			if (status == 0) {
 				return (-1);
 			}
+			buf += run * blocksize - skipfirst;
+			i += run - 1;
 		} else {
 			memset (buf, 0, blocksize - skipfirst);
+			buf += blocksize - skipfirst;
 		}
-		buf += blocksize - skipfirst;
 	}
 	return (len);
 }
@@ -822,6 +1036,12 @@ int ext2fs_close (void
 		indir2_size = 0;
 		indir2_blkno = -1;
 	}
+	if (ext4_nodes != NULL) {
+		free (ext4_nodes);
+		ext4_nodes = NULL;
+		ext4_nodes_size = 0;
+	}
+	ext4_cache_ino = -1;
 	return (0);
 }
 
@@ -865,9 +1085,19 @@ int ext2fs_mount (unsigned part_length) {
 	} else {
 		inode_size = __le16_to_cpu(data->sblock.inode_size);
 	}
+	desc_size = EXT2_MIN_DESC_SIZE;
+	if (__le32_to_cpu(data->sblock.feature_incompat) &
+	    EXT4_FEATURE_INCOMPAT_64BIT) {
+		desc_size = __le16_to_cpu(data->sblock.descriptor_size);
+		if (desc_size < EXT2_MIN_DESC_SIZE)
+			desc_size = EXT2_MIN_DESC_SIZE;
+	}
+	ext4_cache_ino = -1;
+	memset (ext4_node_blkno, 0, sizeof (ext4_node_blkno));
 #ifdef DEBUG
-	printf("EXT2 rev %d, inode_size %d\n",
-			__le32_to_cpu(data->sblock.revision_level), inode_size);
+	printf("EXT2 rev %d, inode_size %d, desc_size %d\n",
+			__le32_to_cpu(data->sblock.revision_level), inode_size,
+			desc_size);
 #endif
 	data->diropen.data = data;
 	data->diropen.ino = 2;
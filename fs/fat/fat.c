@@ -30,6 +30,7 @@
 #include <fat.h>
 #include <asm/byteorder.h>
 #include <part.h>
+#include <malloc.h>
 
 /*
  * Convert a string to lowercase.
@@ -47,6 +48,13 @@ static  block_dev_desc_t *cur_dev = NULL;
 static unsigned long part_offset = 0;
 static int cur_part = 1;
 
+#ifdef CONFIG_SYS_FAT_CACHE_SIZE
+/* Whole FAT of the current partition, see get_fatcache() */
+static __u8 *fatcache = NULL;
+static __u32 fatcache_size = 0;
+static __u32 fatcache_sect = 0;	/* first FAT sector, 0 if invalid */
+#endif
+
 #define DOS_PART_TBL_OFFSET	0x1be
 #define DOS_PART_MAGIC_OFFSET	0x1fe
 #define DOS_FS_TYPE_OFFSET	0x36
@@ -57,8 +65,8 @@ int disk_read (__u32 startblock, __u32 getsize, __u8 * bufptr)
 	if (cur_dev == NULL)
 		return -1;
 	if (cur_dev->block_read) {
-		return cur_dev->block_read (cur_dev->dev
-			, startblock, getsize, (unsigned long *)bufptr);
+		return blkcache_read (cur_dev, startblock, getsize,
+				      (unsigned long *)bufptr);
 	}
 	return -1;
 }
@@ -73,8 +81,11 @@ fat_register_device(block_dev_desc_t *dev_desc, int part_no)
 	if (!dev_desc->block_read)
 		return -1;
 	cur_dev = dev_desc;
+#ifdef CONFIG_SYS_FAT_CACHE_SIZE
+	fatcache_sect = 0;
+#endif
 	/* check if we have a MBR (on floppies we have only a PBR) */
-	if (dev_desc->block_read (dev_desc->dev, 0, 1, (ulong *) buffer) != 1) {
+	if (blkcache_read (dev_desc, 0, 1, (ulong *) buffer) != 1) {
 		printf ("** Can't read from device %d **\n", dev_desc->dev);
 		return -1;
 	}
@@ -168,6 +179,71 @@ static void get_name (dir_entry *dirent, char *s_name)
 	downcase (s_name);
 }
 
+#ifdef CONFIG_SYS_FAT_CACHE_SIZE
+/*
+ * Return the whole FAT of the current partition, reading it in one go
+ * if it is not cached yet. Returns NULL if the FAT is larger than
+ * CONFIG_SYS_FAT_CACHE_SIZE or cannot be read.
+ */
+static __u8 *
+get_fatcache(fsdata *mydata)
+{
+	__u32 size = mydata->fatlength * SECTOR_SIZE;
+
+	if (fatcache_sect == mydata->fat_sect && fatcache_size == size)
+		return fatcache;
+
+	if (size > CONFIG_SYS_FAT_CACHE_SIZE)
+		return NULL;
+
+	fatcache_sect = 0;
+	if (fatcache_size != size) {
+		free(fatcache);
+		fatcache_size = 0;
+		fatcache = malloc(size);
+		if (fatcache == NULL)
+			return NULL;
+		fatcache_size = size;
+	}
+	if (disk_read(mydata->fat_sect, mydata->fatlength, fatcache) < 0) {
+		FAT_DPRINT("Error reading FAT\n");
+		return NULL;
+	}
+	fatcache_sect = mydata->fat_sect;
+
+	return fatcache;
+}
+
+/*
+ * Get the entry at index 'entry' from the cached FAT.
+ * On failure 0x00 is returned.
+ */
+static __u32
+get_fatent_cached(fsdata *mydata, __u8 *fat, __u32 entry)
+{
+	__u32 off;
+
+	switch (mydata->fatsize) {
+	case 32:
+		if (entry >= fatcache_size / 4)
+			return 0;
+		return FAT2CPU32(((__u32 *)fat)[entry]);
+	case 16:
+		if (entry >= fatcache_size / 2)
+			return 0;
+		return FAT2CPU16(((__u16 *)fat)[entry]);
+	case 12:
+		off = entry + entry / 2;
+		if (off + 1 >= fatcache_size)
+			return 0;
+		if (entry & 1)
+			return (fat[off] >> 4) | (fat[off + 1] << 4);
+		return fat[off] | ((fat[off + 1] & 0x0f) << 8);
+	}
+	return 0;
+}
+#endif
+
 /*
  * Get the entry at index 'entry' in a FAT (12/16/32) table.
  * On failure 0x00 is returned.
@@ -178,6 +254,12 @@ get_fatent(fsdata *mydata, __u32 entry)
 	__u32 bufnum;
 	__u32 offset;
 	__u32 ret = 0x00;
+#ifdef CONFIG_SYS_FAT_CACHE_SIZE
+	__u8 *fat = get_fatcache(mydata);
+
+	if (fat)
+		return get_fatent_cached(mydata, fat, entry);
+#endif
 
 	switch (mydata->fatsize) {
 	case 32:
@@ -322,57 +404,41 @@ get_contents(fsdata *mydata, dir_entry *dentptr, __u8 *buffer,
 
 	FAT_DPRINT("Reading: %ld bytes\n", filesize);
 
-	actsize=bytesperclust;
-	endclust=curclust;
-	do {
+	while (filesize > 0) {
 		/* search for consecutive clusters */
-		while(actsize < filesize) {
+		actsize = bytesperclust;
+		endclust = curclust;
+		newclust = 0;
+		while (actsize < filesize) {
 			newclust = get_fatent(mydata, endclust);
-			if((newclust -1)!=endclust)
-				goto getit;
-			if (CHECK_CLUST(newclust, mydata->fatsize)) {
-				FAT_DPRINT("curclust: 0x%x\n", newclust);
-				FAT_DPRINT("Invalid FAT entry\n");
-				return gotsize;
-			}
-			endclust=newclust;
-			actsize+= bytesperclust;
+			if (newclust != endclust + 1)
+				break;
+			endclust = newclust;
+			actsize += bytesperclust;
 		}
-		/* actsize >= file size */
-		actsize -= bytesperclust;
-		/* get remaining clusters */
-		if (get_cluster(mydata, curclust, buffer, (int)actsize) != 0) {
-			FAT_ERROR("Error reading cluster\n");
-			return -1;
-		}
-		/* get remaining bytes */
-		gotsize += (int)actsize;
-		filesize -= actsize;
-		buffer += actsize;
-		actsize= filesize;
-		if (get_cluster(mydata, endclust, buffer, (int)actsize) != 0) {
-			FAT_ERROR("Error reading cluster\n");
-			return -1;
-		}
-		gotsize+=actsize;
-		return gotsize;
-getit:
-		if (get_cluster(mydata, curclust, buffer, (int)actsize) != 0) {
+		if (actsize > filesize)
+			actsize = filesize;
+
+		/* read the whole run at once */
+		if (get_cluster(mydata, curclust, buffer, actsize) != 0) {
 			FAT_ERROR("Error reading cluster\n");
 			return -1;
 		}
-		gotsize += (int)actsize;
+		gotsize += actsize;
 		filesize -= actsize;
 		buffer += actsize;
-		curclust = get_fatent(mydata, endclust);
+		if (filesize == 0)
+			break;
+
+		curclust = newclust;
 		if (CHECK_CLUST(curclust, mydata->fatsize)) {
 			FAT_DPRINT("curclust: 0x%x\n", curclust);
 			FAT_ERROR("Invalid FAT entry\n");
 			return gotsize;
 		}
-		actsize=bytesperclust;
-		endclust=curclust;
-	} while (1);
+	}
+
+	return gotsize;
 }
 
 
@@ -93,9 +93,9 @@
  *   if there are multiple copies of fragments for a certain file offset.
  *
  * The fragment sorting feature must be enabled by CONFIG_SYS_JFFS2_SORT_FRAGMENTS.
- * Sorting is done while adding fragments to the lists, which is more or less a
- * bubble sort. This takes a lot of time, and is most probably not an issue if
- * the boot filesystem is always mounted readonly.
+ * The lists are merge sorted once the scan is complete, on keys the scanner
+ * saves in each b_node. This is most probably not an issue if the boot
+ * filesystem is always mounted readonly.
  *
  * You should define it if the boot filesystem is mounted writable, and updates
  * to the boot files are done by copying files to that filesystem.
@@ -176,8 +176,22 @@ static int read_nand_cached(u32 off, u32 size, u_char *buf)
 	u32 bytes_read = 0;
 	size_t retlen;
 	int cpy_bytes;
+	int ret;
 
 	while (bytes_read < size) {
+		/* large reads (scanning) go straight to the buffer */
+		if (size - bytes_read >= NAND_CACHE_SIZE) {
+			retlen = size - bytes_read;
+			ret = nand_read(&nand_info[id->num], off + bytes_read,
+					&retlen, buf + bytes_read);
+			if ((ret != 0 && ret != -EUCLEAN) ||
+					retlen != size - bytes_read) {
+				printf("read_nand_cached: error reading nand off %#x size %d bytes\n",
+						off + bytes_read, size - bytes_read);
+				return -1;
+			}
+			return size;
+		}
 		if ((off + bytes_read < nand_cache_off) ||
 		    (off + bytes_read >= nand_cache_off+NAND_CACHE_SIZE)) {
 			nand_cache_off = (off + bytes_read) & NAND_PAGE_MASK;
@@ -193,8 +207,9 @@ static int read_nand_cached(u32 off, u32 size, u_char *buf)
 			}
 
 			retlen = NAND_CACHE_SIZE;
-			if (nand_read(&nand_info[id->num], nand_cache_off,
-						&retlen, nand_cache) != 0 ||
+			ret = nand_read(&nand_info[id->num], nand_cache_off,
+					&retlen, nand_cache);
+			if ((ret != 0 && ret != -EUCLEAN) ||
 					retlen != NAND_CACHE_SIZE) {
 				printf("read_nand_cached: error reading nand off %#x size %d bytes\n",
 						nand_cache_off, NAND_CACHE_SIZE);
@@ -277,6 +292,18 @@ static int read_onenand_cached(u32 off, u32 size, u_char *buf)
 	int cpy_bytes;
 
 	while (bytes_read < size) {
+		/* large reads (scanning) go straight to the buffer */
+		if (size - bytes_read >= ONENAND_CACHE_SIZE) {
+			retlen = size - bytes_read;
+			if (onenand_read(&onenand_mtd, off + bytes_read, retlen,
+					&retlen, buf + bytes_read) != 0 ||
+					retlen != size - bytes_read) {
+				printf("read_onenand_cached: error reading nand off %#x size %d bytes\n",
+					off + bytes_read, size - bytes_read);
+				return -1;
+			}
+			return size;
+		}
 		if ((off + bytes_read < onenand_cache_off) ||
 		    (off + bytes_read >= onenand_cache_off + ONENAND_CACHE_SIZE)) {
 			onenand_cache_off = (off + bytes_read) & ONENAND_PAGE_MASK;
@@ -544,50 +571,49 @@ static struct b_node *
 insert_node(struct b_list *list, u32 offset)
 {
 	struct b_node *new;
-#ifdef CONFIG_SYS_JFFS2_SORT_FRAGMENTS
-	struct b_node *b, *prev;
-#endif
 
 	if (!(new = add_node(list))) {
 		putstr("add_node failed!\r\n");
 		return NULL;
 	}
 	new->offset = offset;
+	new->next = (struct b_node *) NULL;
+	if (list->listTail != NULL) {
+		list->listTail->next = new;
+		list->listTail = new;
+	} else {
+		list->listTail = list->listHead = new;
+	}
+
+	return new;
+}
+
+static struct b_node *
+insert_inode(struct b_list *list, u32 offset, u32 version)
+{
+	struct b_node *new = insert_node(list, offset);
 
 #ifdef CONFIG_SYS_JFFS2_SORT_FRAGMENTS
-	if (list->listTail != NULL && list->listCompare(new, list->listTail))
-		prev = list->listTail;
-	else if (list->listLast != NULL && list->listCompare(new, list->listLast))
-		prev = list->listLast;
-	else
-		prev = NULL;
+	if (new)
+		new->version = version;
+#endif
+	return new;
+}
 
-	for (b = (prev ? prev->next : list->listHead);
-	     b != NULL && list->listCompare(new, b);
-	     prev = b, b = b->next) {
-		list->listLoops++;
+static struct b_node *
+insert_dirent(struct b_list *list, u32 offset, u32 pino, u32 version,
+	      u32 name_crc, u8 nsize)
+{
+	struct b_node *new = insert_node(list, offset);
+
+#ifdef CONFIG_SYS_JFFS2_SORT_FRAGMENTS
+	if (new) {
+		new->version = version;
+		new->pino = pino;
+		new->nsize = nsize;
+		new->name_crc = name_crc;
 	}
-	if (b != NULL)
-		list->listLast = prev;
-
-	if (b != NULL) {
-		new->next = b;
-		if (prev != NULL)
-			prev->next = new;
-		else
-			list->listHead = new;
-	} else
 #endif
-	{
-		new->next = (struct b_node *) NULL;
-		if (list->listTail != NULL) {
-			list->listTail->next = new;
-			list->listTail = new;
-		} else {
-			list->listTail = list->listHead = new;
-		}
-	}
-
 	return new;
 }
 
@@ -597,59 +623,78 @@ insert_node(struct b_list *list, u32 offset)
  */
 static int compare_inodes(struct b_node *new, struct b_node *old)
 {
-	struct jffs2_raw_inode ojNew;
-	struct jffs2_raw_inode ojOld;
-	struct jffs2_raw_inode *jNew =
-		(struct jffs2_raw_inode *)get_fl_mem(new->offset, sizeof(ojNew), &ojNew);
-	struct jffs2_raw_inode *jOld =
-		(struct jffs2_raw_inode *)get_fl_mem(old->offset, sizeof(ojOld), &ojOld);
-
-	return jNew->version > jOld->version;
+	return new->version > old->version;
 }
 
 /* Sort directory entries so all entries in the same directory
  * with the same name are grouped together, with the latest version
- * last. This makes it easy to eliminate all but the latest version
- * by marking the previous version dead by setting the inode to 0.
+ * last. Names are compared by length and CRC only, which is enough
+ * to group them and needs no flash access.
  */
 static int compare_dirents(struct b_node *new, struct b_node *old)
 {
-	struct jffs2_raw_dirent ojNew;
-	struct jffs2_raw_dirent ojOld;
-	struct jffs2_raw_dirent *jNew =
-		(struct jffs2_raw_dirent *)get_fl_mem(new->offset, sizeof(ojNew), &ojNew);
-	struct jffs2_raw_dirent *jOld =
-		(struct jffs2_raw_dirent *)get_fl_mem(old->offset, sizeof(ojOld), &ojOld);
-	int cmp;
-
-	/* ascending sort by pino */
-	if (jNew->pino != jOld->pino)
-		return jNew->pino > jOld->pino;
-
-	/* pino is the same, so use ascending sort by nsize, so
-	 * we don't do strncmp unless we really must.
-	 */
-	if (jNew->nsize != jOld->nsize)
-		return jNew->nsize > jOld->nsize;
+	if (new->pino != old->pino)
+		return new->pino > old->pino;
+	if (new->nsize != old->nsize)
+		return new->nsize > old->nsize;
+	if (new->name_crc != old->name_crc)
+		return new->name_crc > old->name_crc;
+	return new->version > old->version;
+}
 
-	/* length is also the same, so use ascending sort by name
-	 */
-	cmp = strncmp((char *)jNew->name, (char *)jOld->name, jNew->nsize);
-	if (cmp != 0)
-		return cmp > 0;
+/*
+ * Sort a list with its listCompare function once the scan has added
+ * all nodes. This is a stable bottom-up merge sort, O(n log n) on the
+ * keys cached in the b_nodes.
+ */
+static void sort_list(struct b_list *list)
+{
+	struct b_node *head = list->listHead;
+	struct b_node *p, *q, *e, *tail;
+	u32 insize, nmerges, psize, qsize;
 
-	/* we have duplicate names in this directory, so use ascending
-	 * sort by version
-	 */
-	if (jNew->version > jOld->version) {
-		/* since jNew is newer, we know jOld is not valid, so
-		 * mark it with inode 0 and it will not be used
-		 */
-		jOld->ino = 0;
-		return 1;
+	if (head == NULL)
+		return;
+
+	for (insize = 1; ; insize *= 2) {
+		p = head;
+		head = tail = NULL;
+		nmerges = 0;
+
+		while (p) {
+			nmerges++;
+			q = p;
+			for (psize = 0; psize < insize && q; psize++)
+				q = q->next;
+			qsize = insize;
+
+			while (psize > 0 || (qsize > 0 && q)) {
+				if (psize == 0 ||
+				    (qsize > 0 && q && list->listCompare(p, q))) {
+					e = q;
+					q = q->next;
+					qsize--;
+				} else {
+					e = p;
+					p = p->next;
+					psize--;
+				}
+				if (tail)
+					tail->next = e;
+				else
+					head = e;
+				tail = e;
+			}
+			p = q;
+		}
+		tail->next = NULL;
+
+		if (nmerges <= 1)
+			break;
 	}
 
-	return 0;
+	list->listHead = head;
+	list->listTail = tail;
 }
 #endif
 
@@ -1233,11 +1278,12 @@ static u16 sum_get_unaligned16(u16 *ptr)
 
 static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 				struct jffs2_raw_summary *summary,
-				struct b_lists *pL)
+				struct b_lists *pL, u32 *max_totlen)
 {
 	void *sp;
 	int i, pass;
 	void *ret;
+	u32 totlen;
 
 	for (pass = 0; pass < 2; pass++) {
 		sp = summary->sum;
@@ -1252,13 +1298,19 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 					if (pass) {
 						spi = sp;
 
-						ret = insert_node(&pL->frag,
+						ret = insert_inode(&pL->frag,
 							(u32)part->offset +
 							offset +
 							sum_get_unaligned32(
-								&spi->offset));
+								&spi->offset),
+							sum_get_unaligned32(
+								&spi->version));
 						if (ret == NULL)
 							return -1;
+						totlen = sum_get_unaligned32(
+								&spi->totlen);
+						if (*max_totlen < totlen)
+							*max_totlen = totlen;
 					}
 
 					sp += JFFS2_SUMMARY_INODE_SIZE;
@@ -1269,13 +1321,26 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 					struct jffs2_sum_dirent_flash *spd;
 					spd = sp;
 					if (pass) {
-						ret = insert_node(&pL->dir,
+						ret = insert_dirent(&pL->dir,
 							(u32) part->offset +
 							offset +
 							sum_get_unaligned32(
-								&spd->offset));
+								&spd->offset),
+							sum_get_unaligned32(
+								&spd->pino),
+							sum_get_unaligned32(
+								&spd->version),
+							/* no name CRC in summaries */
+							crc32_no_comp(0,
+								spd->name,
+								spd->nsize),
+							spd->nsize);
 						if (ret == NULL)
 							return -1;
+						totlen = sum_get_unaligned32(
+								&spd->totlen);
+						if (*max_totlen < totlen)
+							*max_totlen = totlen;
 					}
 
 					sp += JFFS2_SUMMARY_DIRENT_SIZE(
@@ -1303,7 +1368,7 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 /* Process the summary node - called from jffs2_scan_eraseblock() */
 int jffs2_sum_scan_sumnode(struct part_info *part, uint32_t offset,
 			   struct jffs2_raw_summary *summary, uint32_t sumsize,
-			   struct b_lists *pL)
+			   struct b_lists *pL, u32 *max_totlen)
 {
 	struct jffs2_unknown_node crcnode;
 	int ret, ofs;
@@ -1350,7 +1415,8 @@ int jffs2_sum_scan_sumnode(struct part_info *part, uint32_t offset,
 	if (summary->cln_mkr)
 		dbg_summary("Summary : CLEANMARKER node \n");
 
-	ret = jffs2_sum_process_sum_data(part, offset, summary, pL);
+	ret = jffs2_sum_process_sum_data(part, offset, summary, pL,
+					 max_totlen);
 	if (ret == -EBADMSG)
 		return 0;
 	if (ret)
@@ -1430,6 +1496,10 @@ dump_dirents(struct b_lists *pL)
 
 #define DEFAULT_EMPTY_SCAN_SIZE	4096
 
+#ifndef CONFIG_SYS_JFFS2_SCAN_BUFSIZE
+#define CONFIG_SYS_JFFS2_SCAN_BUFSIZE	(128 << 10)
+#endif
+
 static inline uint32_t EMPTY_SCAN_SIZE(uint32_t sector_size)
 {
 	if (sector_size < DEFAULT_EMPTY_SCAN_SIZE)
@@ -1438,6 +1508,42 @@ static inline uint32_t EMPTY_SCAN_SIZE(uint32_t sector_size)
 		return DEFAULT_EMPTY_SCAN_SIZE;
 }
 
+/*
+ * Return the number of erased (0xFF) bytes at the start of buf, looking
+ * at no more than len bytes. Most of a scan is spent in erased space,
+ * so check four words per iteration.
+ */
+static u32 jffs2_empty_len(const char *buf, u32 len)
+{
+	const u32 *p = (const u32 *)buf;
+	u32 n = len / 4;
+	u32 i = 0;
+
+	while (i + 4 <= n &&
+	       (p[i] & p[i + 1] & p[i + 2] & p[i + 3]) == 0xFFFFFFFF)
+		i += 4;
+	while (i < n && p[i] == 0xFFFFFFFF)
+		i++;
+
+	return i * 4;
+}
+
+/*
+ * Get part of the partition for the scanner. NOR flash is scanned in
+ * place, everything else is read into buf. A failed read is treated
+ * as erased space so the scan moves on.
+ */
+static char *jffs2_scan_read(u32 off, u32 len, char *buf)
+{
+#if defined(CONFIG_CMD_FLASH)
+	if (current_part->dev->id->type == MTD_DEV_TYPE_NOR)
+		return get_fl_mem_nor(off, len, NULL);
+#endif
+	if (get_fl_mem(off, len, buf) == NULL)
+		memset(buf, 0xff, len);
+	return buf;
+}
+
 static u32
 jffs2_1pass_build_lists(struct part_info * part)
 {
@@ -1449,8 +1555,8 @@ jffs2_1pass_build_lists(struct part_info * part)
 	u32 counterF = 0;
 	u32 counterN = 0;
 	u32 max_totlen = 0;
-	u32 buf_size = DEFAULT_EMPTY_SCAN_SIZE;
-	char *buf;
+	u32 buf_size;
+	char *scanbuf, *buf;
 
 	/* turn off the lcd.  Refreshing the lcd adds 50% overhead to the */
 	/* jffs2 list building enterprise nope.  in newer versions the overhead is */
@@ -1460,7 +1566,21 @@ jffs2_1pass_build_lists(struct part_info * part)
 	/* if we are building a list we need to refresh the cache. */
 	jffs_init_1pass_list(part);
 	pL = (struct b_lists *)part->jffs2_priv;
-	buf = malloc(buf_size);
+
+	/* read as much of an eraseblock at once as we can */
+	buf_size = min_t(u32, part->sector_size, CONFIG_SYS_JFFS2_SCAN_BUFSIZE);
+	if (buf_size < DEFAULT_EMPTY_SCAN_SIZE)
+		buf_size = DEFAULT_EMPTY_SCAN_SIZE;
+	scanbuf = malloc(buf_size);
+	if (!scanbuf) {
+		buf_size = DEFAULT_EMPTY_SCAN_SIZE;
+		scanbuf = malloc(buf_size);
+	}
+	if (!scanbuf) {
+		putstr("Can't get memory for scan buffer!\n");
+		jffs2_free_cache(part);
+		return 0;
+	}
 	puts ("Scanning JFFS2 FS:   ");
 
 	/* start at the beginning of the partition */
@@ -1469,6 +1589,7 @@ jffs2_1pass_build_lists(struct part_info * part)
 		uint32_t buf_ofs = sector_ofs;
 		uint32_t buf_len;
 		uint32_t ofs, prevofs;
+		struct jffs2_raw_dirent *dirent;
 #ifdef CONFIG_JFFS2_SUMMARY
 		struct jffs2_sum_marker *sm;
 		void *sumptr = NULL;
@@ -1485,12 +1606,12 @@ jffs2_1pass_build_lists(struct part_info * part)
 		 * buffer
 		 */
 		get_fl_mem(part->offset + sector_ofs + part->sector_size -
-				buf_len, buf_len, buf + buf_size - buf_len);
+				buf_len, buf_len, scanbuf + buf_size - buf_len);
 
-		sm = (void *)buf + buf_size - sizeof(*sm);
+		sm = (void *)scanbuf + buf_size - sizeof(*sm);
 		if (sm->magic == JFFS2_SUM_MAGIC) {
 			sumlen = part->sector_size - sm->offset;
-			sumptr = buf + buf_size - sumlen;
+			sumptr = scanbuf + buf_size - sumlen;
 
 			/* Now, make sure the summary itself is available */
 			if (sumlen > buf_size) {
@@ -1499,11 +1620,11 @@ jffs2_1pass_build_lists(struct part_info * part)
 				if (!sumptr) {
 					putstr("Can't get memory for summary "
 							"node!\n");
-					free(buf);
+					free(scanbuf);
 					jffs2_free_cache(part);
 					return 0;
 				}
-				memcpy(sumptr + sumlen - buf_len, buf +
+				memcpy(sumptr + sumlen - buf_len, scanbuf +
 						buf_size - buf_len, buf_len);
 			}
 			if (buf_len < sumlen) {
@@ -1518,12 +1639,12 @@ jffs2_1pass_build_lists(struct part_info * part)
 
 		if (sumptr) {
 			ret = jffs2_sum_scan_sumnode(part, sector_ofs, sumptr,
-					sumlen, pL);
+					sumlen, pL, &max_totlen);
 
 			if (buf_size && sumlen > buf_size)
 				free(sumptr);
 			if (ret < 0) {
-				free(buf);
+				free(scanbuf);
 				jffs2_free_cache(part);
 				return 0;
 			}
@@ -1535,17 +1656,24 @@ jffs2_1pass_build_lists(struct part_info * part)
 
 		buf_len = EMPTY_SCAN_SIZE(part->sector_size);
 
-		get_fl_mem((u32)part->offset + buf_ofs, buf_len, buf);
+		buf = jffs2_scan_read((u32)part->offset + buf_ofs, buf_len,
+				      scanbuf);
 
 		/* We temporarily use 'ofs' as a pointer into the buffer/jeb */
-		ofs = 0;
-
 		/* Scan only 4KiB of 0xFF before declaring it's empty */
-		while (ofs < EMPTY_SCAN_SIZE(part->sector_size) &&
-				*(uint32_t *)(&buf[ofs]) == 0xFFFFFFFF)
-			ofs += 4;
+		ofs = jffs2_empty_len(buf, buf_len);
+		if (ofs == buf_len)
+			continue;
 
-		if (ofs == EMPTY_SCAN_SIZE(part->sector_size))
+		/* The same goes for a cleanmarker followed by 4KiB of 0xFF,
+		 * as in Linux: the block has been erased and not written to.
+		 */
+		node = (struct jffs2_unknown_node *)buf;
+		if (ofs == 0 && node->magic == JFFS2_MAGIC_BITMASK &&
+		    node->nodetype == JFFS2_NODETYPE_CLEANMARKER &&
+		    node->totlen == sizeof(*node) && hdr_crc(node) &&
+		    jffs2_empty_len(buf + sizeof(*node), buf_len -
+				    sizeof(*node)) == buf_len - sizeof(*node))
 			continue;
 
 		ofs += sector_ofs;
@@ -1566,32 +1694,24 @@ jffs2_1pass_build_lists(struct part_info * part)
 			if (buf_ofs + buf_len < ofs + sizeof(*node)) {
 				buf_len = min_t(uint32_t, buf_size, sector_ofs
 						+ part->sector_size - ofs);
-				get_fl_mem((u32)part->offset + ofs, buf_len,
-					   buf);
+				buf = jffs2_scan_read((u32)part->offset + ofs,
+						      buf_len, scanbuf);
 				buf_ofs = ofs;
 			}
 
 			node = (struct jffs2_unknown_node *)&buf[ofs-buf_ofs];
 
 			if (*(uint32_t *)(&buf[ofs-buf_ofs]) == 0xffffffff) {
-				uint32_t inbuf_ofs;
-				uint32_t empty_start, scan_end;
+				uint32_t inbuf_ofs, empty;
 
-				empty_start = ofs;
 				ofs += 4;
-				scan_end = min_t(uint32_t, EMPTY_SCAN_SIZE(
-							part->sector_size)/8,
-							buf_len);
 			more_empty:
 				inbuf_ofs = ofs - buf_ofs;
-				while (inbuf_ofs < scan_end) {
-					if (*(uint32_t *)(&buf[inbuf_ofs]) !=
-							0xffffffff)
-						goto scan_more;
-
-					inbuf_ofs += 4;
-					ofs += 4;
-				}
+				empty = jffs2_empty_len(&buf[inbuf_ofs],
+							buf_len - inbuf_ofs);
+				ofs += empty;
+				if (inbuf_ofs + empty < buf_len)
+					goto scan_more;
 				/* Ran off end. */
 
 				/* See how much more there is to read in this
@@ -1608,9 +1728,8 @@ jffs2_1pass_build_lists(struct part_info * part)
 					 */
 					break;
 				}
-				scan_end = buf_len;
-				get_fl_mem((u32)part->offset + ofs, buf_len,
-					   buf);
+				buf = jffs2_scan_read((u32)part->offset + ofs,
+						      buf_len, scanbuf);
 				buf_ofs = ofs;
 				goto more_empty;
 			}
@@ -1631,17 +1750,21 @@ jffs2_1pass_build_lists(struct part_info * part)
 			case JFFS2_NODETYPE_INODE:
 				if (buf_ofs + buf_len < ofs + sizeof(struct
 							jffs2_raw_inode)) {
-					get_fl_mem((u32)part->offset + ofs,
-						   buf_len, buf);
+					buf_len = min_t(uint32_t, buf_size,
+							sector_ofs +
+							part->sector_size - ofs);
+					buf = jffs2_scan_read((u32)part->offset
+							+ ofs, buf_len, scanbuf);
 					buf_ofs = ofs;
 					node = (void *)buf;
 				}
 				if (!inode_crc((struct jffs2_raw_inode *) node))
 				       break;
 
-				if (insert_node(&pL->frag, (u32) part->offset +
-						ofs) == NULL) {
-					free(buf);
+				if (insert_inode(&pL->frag, (u32) part->offset +
+						ofs, ((struct jffs2_raw_inode *)
+						node)->version) == NULL) {
+					free(scanbuf);
 					jffs2_free_cache(part);
 					return 0;
 				}
@@ -1654,8 +1777,11 @@ jffs2_1pass_build_lists(struct part_info * part)
 							((struct
 							 jffs2_raw_dirent *)
 							node)->nsize) {
-					get_fl_mem((u32)part->offset + ofs,
-						   buf_len, buf);
+					buf_len = min_t(uint32_t, buf_size,
+							sector_ofs +
+							part->sector_size - ofs);
+					buf = jffs2_scan_read((u32)part->offset
+							+ ofs, buf_len, scanbuf);
 					buf_ofs = ofs;
 					node = (void *)buf;
 				}
@@ -1669,9 +1795,11 @@ jffs2_1pass_build_lists(struct part_info * part)
 					break;
 				if (! (counterN%100))
 					puts ("\b\b.  ");
-				if (insert_node(&pL->dir, (u32) part->offset +
-						ofs) == NULL) {
-					free(buf);
+				dirent = (struct jffs2_raw_dirent *)node;
+				if (insert_dirent(&pL->dir, (u32) part->offset +
+						ofs, dirent->pino, dirent->version,
+						dirent->name_crc, dirent->nsize) == NULL) {
+					free(scanbuf);
 					jffs2_free_cache(part);
 					return 0;
 				}
@@ -1705,7 +1833,12 @@ jffs2_1pass_build_lists(struct part_info * part)
 		}
 	}
 
-	free(buf);
+	free(scanbuf);
+
+#ifdef CONFIG_SYS_JFFS2_SORT_FRAGMENTS
+	sort_list(&pL->frag);
+	sort_list(&pL->dir);
+#endif
 	putstr("\b\b done.\r\n");		/* close off the dots */
 
 	/* We don't care if malloc failed - then each read operation will
@@ -8,6 +8,13 @@ struct b_node {
 	u32 offset;
 	struct b_node *next;
 	enum { CRC_UNKNOWN = 0, CRC_OK, CRC_BAD } datacrc;
+#ifdef CONFIG_SYS_JFFS2_SORT_FRAGMENTS
+	/* sort keys, saved by the scanner so sorting needs no flash reads */
+	u32 version;
+	u32 pino;		/* dirents only */
+	u32 name_crc;		/* dirents only */
+	u8 nsize;		/* dirents only */
+#endif
 };
 
 struct b_list {
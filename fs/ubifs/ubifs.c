@@ -520,23 +520,13 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+static int decompress_block(struct ubifs_info *c, struct inode *inode,
+			    void *addr, unsigned int block,
+			    struct ubifs_data_node *dn)
 {
-	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -567,6 +557,25 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	int err;
+	union ubifs_key key;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return decompress_block(c, inode, addr, block, dn);
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode, struct page *page)
 {
 	void *addr;
@@ -640,14 +649,83 @@ error:
 	return err;
 }
 
+/**
+ * do_bulk_read - read a number of pages with one UBI read.
+ * @c: UBIFS file-system description object
+ * @bu: bulk-read information with a buffer of @c->max_bu_buf_len bytes
+ * @page: the first page to read
+ * @pages: maximum number of pages to read
+ *
+ * This function looks up the data nodes of the pages starting at @page which
+ * sit one after another in the same LEB, reads them all in one go and
+ * decompresses them to their pages. Returns the number of pages read, %0 if
+ * there are not enough nodes to bother, in which case the caller should read
+ * the page with 'do_readpage()', or a negative error code in case of failure.
+ */
+static int do_bulk_read(struct ubifs_info *c, struct bu_info *bu,
+			struct page *page, unsigned int pages)
+{
+	struct inode *inode = page->inode;
+	loff_t i_size = inode->i_size;
+	unsigned int block, first, last, beyond;
+	void *addr = kmap(page);
+	int err, n = 0;
+
+	first = page->index << UBIFS_BLOCKS_PER_PAGE_SHIFT;
+	data_key_init(c, &bu->key, inode->i_ino, first);
+	err = ubifs_tnc_get_bu_keys(c, bu);
+	if (err)
+		return err;
+
+	if (bu->cnt < 2)
+		return 0;
+
+	err = ubifs_tnc_bulk_read(c, bu);
+	if (err)
+		return err;
+
+	/* Pages up to the last node read, the blocks in between are holes */
+	last = key_block(c, &bu->zbranch[bu->cnt - 1].key);
+	pages = min(pages, ((last - first) >> UBIFS_BLOCKS_PER_PAGE_SHIFT) + 1);
+
+	beyond = (i_size + UBIFS_BLOCK_SIZE - 1) >> UBIFS_BLOCK_SHIFT;
+	last = first + (pages << UBIFS_BLOCKS_PER_PAGE_SHIFT);
+	for (block = first; block < last; block++, addr += UBIFS_BLOCK_SIZE) {
+		struct ubifs_zbranch *zbr = &bu->zbranch[n];
+		struct ubifs_data_node *dn;
+
+		if (n == bu->cnt || key_block(c, &zbr->key) != block) {
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+			continue;
+		}
+
+		dn = bu->buf + zbr->offs - bu->zbranch[0].offs;
+		err = decompress_block(c, inode, addr, block, dn);
+		if (err)
+			return err;
+		n += 1;
+
+		if (block + 1 == beyond) {
+			int dlen = le32_to_cpu(dn->size);
+			int ilen = i_size & (UBIFS_BLOCK_SIZE - 1);
+
+			if (ilen && ilen < dlen)
+				memset(addr + ilen, 0, dlen - ilen);
+		}
+	}
+
+	return pages;
+}
+
 int ubifs_load(char *filename, u32 addr, u32 size)
 {
 	struct ubifs_info *c = ubifs_sb->s_fs_info;
 	unsigned long inum;
 	struct inode *inode;
 	struct page page;
+	struct bu_info *bu;
 	int err = 0;
-	int i;
+	int i, n;
 	int count;
 
 	c->ubi = ubi_open_volume(c->vi.ubi_num, c->vi.vol_id, UBI_READONLY);
@@ -680,16 +758,35 @@ int ubifs_load(char *filename, u32 addr, u32 size)
 	printf("Loading file '%s' to addr 0x%08x with size %d (0x%08x)...\n",
 	       filename, addr, size, size);
 
+	/*
+	 * Data nodes are mostly written one after another, so read as many of
+	 * them as possible at once. Without memory for that, read page by page.
+	 */
+	bu = kmalloc(sizeof(struct bu_info), GFP_NOFS);
+	if (bu) {
+		bu->buf_len = c->max_bu_buf_len;
+		bu->buf = kmalloc(bu->buf_len, GFP_NOFS);
+		if (!bu->buf) {
+			kfree(bu);
+			bu = NULL;
+		}
+	}
+
 	page.addr = (void *)addr;
 	page.index = 0;
 	page.inode = inode;
-	for (i = 0; i < count; i++) {
-		err = do_readpage(c, inode, &page);
+	for (i = 0; i < count; i += n) {
+		n = bu ? do_bulk_read(c, bu, &page, count - i) : 0;
+		if (n == 0) {
+			err = do_readpage(c, inode, &page);
+			n = 1;
+		} else if (n < 0)
+			err = n;
 		if (err)
 			break;
 
-		page.addr += PAGE_SIZE;
-		page.index++;
+		page.addr += n * PAGE_SIZE;
+		page.index += n;
 	}
 
 	if (err)
@@ -697,6 +794,10 @@ int ubifs_load(char *filename, u32 addr, u32 size)
 	else
 		printf("Done\n");
 
+	if (bu) {
+		kfree(bu->buf);
+		kfree(bu);
+	}
 	ubifs_iput(inode);
 
 out:
@@ -0,0 +1,47 @@
+/*
+ * (C) Copyright 2010
+ * The U-Boot Authors
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Boot time recorder
+ *
+ * bootstage_mark() stores the current timebase value together with
+ * the name of a boot stage in a small ring buffer.  The records can be
+ * printed with the "bootstage" command and can be passed to the OS in
+ * a /bootstage node of the device tree.
+ */
+
+#ifndef __BOOTSTAGE_H
+#define __BOOTSTAGE_H
+
+#ifdef CONFIG_BOOTSTAGE
+void bootstage_mark(const char *name);
+void bootstage_report(void);
+#ifdef CONFIG_BOOTSTAGE_FDT
+int bootstage_fdt_add(void *blob);
+#endif
+#else
+static inline void bootstage_mark(const char *name) {}
+static inline void bootstage_report(void) {}
+#endif
+
+#endif /* __BOOTSTAGE_H */
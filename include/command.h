@@ -73,6 +73,10 @@ cmd_tbl_t *find_cmd_tbl (const char *cmd, cmd_tbl_t *table, int table_len);
 
 extern int cmd_usage(cmd_tbl_t *cmdtp);
 
+#ifdef CONFIG_SYS_CMD_INDEX
+extern void cmd_index_init(void);
+#endif
+
 #ifdef CONFIG_AUTO_COMPLETE
 extern void install_auto_complete(void);
 extern int cmd_auto_complete(const char *const prompt, char *buf, int *np, int *colp);
@@ -144,10 +144,23 @@ unsigned char env_get_char (int);
 unsigned char *env_get_addr(int);
 unsigned char env_get_char_memory (int index);
 
-/* Function that updates CRC of the enironment */
+/*
+ * Function that updates CRC of the enironment; setenv doesn't,
+ * so each saveenv() has to before writing env_ptr out
+ */
 void env_crc_update (void);
 
 /* [re]set to the default environment */
 void set_default_env(void);
 
+#ifdef CONFIG_ENV_HASH
+/* Hash index over the in-RAM environment, see common/env_common.c */
+int env_hash_ready(void);
+void env_hash_rebuild(void);
+int env_hash_lookup(const char *name);
+int env_hash_append_offset(void);
+void env_hash_insert(int index);
+void env_hash_delete(int index, int len);
+#endif
+
 #endif	/* _ENVIRONMENT_H_ */
@@ -31,6 +31,12 @@
 extern int u_boot_hush_start(void);
 extern int parse_string_outer(char *, int);
 extern int parse_file_outer(void);
+#if defined(CONFIG_HUSH_PARSE_CACHE) && defined(CONFIG_SYS_HUSH_PARSER)
+int parse_string_cached(const char *name, char *s, int flag);
+void hush_cache_invalidate(const char *name);
+#else
+static inline void hush_cache_invalidate(const char *name) { }
+#endif
 
 int set_local_var(const char *s, int flg_export);
 void unset_local_var(const char *name);
@@ -282,6 +282,19 @@ typedef struct bootm_headers {
 #define CHUNKSZ_SHA1 (64 * 1024)
 #endif
 
+/*
+ * FIT hashes of one image are computed in a single pass over the data,
+ * CHUNKSZ_FIT_HASH bytes at a time, so that each chunk is still in the
+ * cache when the next algorithm reads it.
+ */
+#ifndef CHUNKSZ_FIT_HASH
+#define CHUNKSZ_FIT_HASH (16 * 1024)
+#endif
+
+#ifndef CONFIG_SYS_BOOTM_LEN
+#define CONFIG_SYS_BOOTM_LEN	0x800000	/* use 8MByte as default max gunzip size */
+#endif
+
 #define uimage_to_cpu(x)		be32_to_cpu(x)
 #define cpu_to_uimage(x)		cpu_to_be32(x)
 
@@ -470,6 +483,13 @@ static inline int image_check_os (const image_header_t *hdr, uint8_t os)
 	return (image_get_os (hdr) == os);
 }
 
+#if defined(CONFIG_IMAGE_STREAM) && !defined(USE_HOSTCC)
+/* common/image_stream.c: unpack images while they are received */
+void image_stream_start (ulong addr);
+int image_stream_write (const uchar *buf, ulong len);
+int image_stream_finish (ulong *size);
+#endif
+
 ulong image_multi_count (const image_header_t *hdr);
 void image_multi_getimg (const image_header_t *hdr, ulong idx,
 			ulong *data, ulong *len);
@@ -541,6 +561,7 @@ static inline int image_check_target_arch (const image_header_t *hdr)
 #define FIT_DEFAULT_PROP	"default"
 
 #define FIT_MAX_HASH_LEN	20	/* max(crc32_len(4), sha1_len(20)) */
+#define FIT_MAX_HASHES		8	/* hash nodes computed in one pass */
 
 /* cmdline argument format parsing */
 inline int fit_parse_conf (const char *spec, ulong addr_curr,
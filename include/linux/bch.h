@@ -0,0 +1,89 @@
+/*
+ * Generic binary BCH encoding/decoding library
+ *
+ * Based on include/linux/bch.h from the Linux kernel:
+ * Copyright (C) 2011 Parrot S.A.
+ * Author: Ivan Djelic <ivan.djelic@parrot.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#ifndef _BCH_H
+#define _BCH_H
+
+#ifdef USE_HOSTCC
+#include <stdint.h>
+#else
+#include <linux/types.h>
+#endif
+
+#define BCH_MIN_M	5
+#define BCH_MAX_M	15
+
+/**
+ * struct bch_control - BCH control structure
+ * @m:		Galois field order, the field is GF(2^m)
+ * @n:		maximum codeword length in bits, 2^m - 1
+ * @t:		number of correctable bit errors
+ * @ecc_bits:	number of ECC bits, the degree of the generator polynomial
+ * @ecc_bytes:	number of ECC bytes, ecc_bits rounded up to whole bytes
+ * @ecc_words:	number of 32-bit words holding the ECC bits
+ * @a_pow_tab:	antilog table, a_pow_tab[i] = a^i
+ * @a_log_tab:	log table, a_log_tab[a^i] = i
+ * @mod_tab:	remainders of byte values times x^(ecc_bits + 8k) modulo the
+ *		generator polynomial, for k = 0..3 (encoder tables)
+ * @ecc_buf:	ECC remainder being computed
+ * @ecc_buf2:	ECC remainder of the received data
+ * @syn:	syndromes S_1..S_2t
+ * @elp:	error locator polynomial
+ * @elp_prev:	Berlekamp-Massey polynomial of the last length change
+ * @elp_tmp:	Berlekamp-Massey scratch polynomial
+ * @chien:	logs and degrees of the non-zero error locator terms, used
+ *		by the root search
+ */
+struct bch_control {
+	unsigned int	m;
+	unsigned int	n;
+	unsigned int	t;
+	unsigned int	ecc_bits;
+	unsigned int	ecc_bytes;
+	unsigned int	ecc_words;
+	uint16_t	*a_pow_tab;
+	uint16_t	*a_log_tab;
+	uint32_t	*mod_tab;
+	uint32_t	*ecc_buf;
+	uint32_t	*ecc_buf2;
+	unsigned int	*syn;
+	unsigned int	*elp;
+	unsigned int	*elp_prev;
+	unsigned int	*elp_tmp;
+	int		*chien;
+};
+
+struct bch_control *init_bch(int m, int t, unsigned int prim_poly);
+
+void free_bch(struct bch_control *bch);
+
+void encode_bch(struct bch_control *bch, const uint8_t *data,
+		unsigned int len, uint8_t *ecc);
+
+int decode_bch(struct bch_control *bch, const uint8_t *data, unsigned int len,
+	       const uint8_t *recv_ecc, const uint8_t *calc_ecc,
+	       unsigned int *errloc);
+
+void correct_bch(struct bch_control *bch, uint8_t *data, unsigned int len,
+		 unsigned int *errloc, int nerr);
+
+#endif /* _BCH_H */
@@ -0,0 +1,63 @@
+/*
+ * (C) Copyright 2010
+ * The U-Boot Authors
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Memory test engine shared by "mtest" and the memory POST
+ *
+ * The region is swept with 64-bit accesses, four words per loop
+ * iteration, in chunks of MEMTEST_CHUNK bytes.  The watchdog is
+ * kicked, ctrl-c is polled and progress is shown once per chunk.
+ */
+
+#ifndef __MEMTEST_H
+#define __MEMTEST_H
+
+/* tests */
+#define MEMTEST_DATALINE	0x0001	/* walking 1/0 on the data bus */
+#define MEMTEST_ADDRLINE	0x0002	/* power-of-two address aliasing */
+#define MEMTEST_WALK		0x0004	/* walking ones and zeros blocks */
+#define MEMTEST_MOVINV		0x0008	/* moving inversions */
+#define MEMTEST_ADDR		0x0010	/* address in address */
+#define MEMTEST_ALL		0x001f
+
+/* options */
+#define MEMTEST_PROGRESS	0x0100	/* show test name and percentage */
+#define MEMTEST_CTRLC		0x0200	/* stop on ctrl-c, return -1 */
+#define MEMTEST_FIRST_ERROR	0x0400	/* stop at the first error */
+
+#define MEMTEST_CHUNK		(1 << 20)
+
+/* Called for every failing location */
+typedef void (memtest_err_f)(const char *test, ulong addr,
+			     u64 expected, u64 actual);
+
+/*
+ * Test 'size' bytes at 'start' (both are rounded inwards to 32 bytes).
+ * A non-zero 32-bit 'pattern' replaces the 0x55.. of the moving
+ * inversions and is XORed into the address test.
+ * Returns the number of errors found, or -1 if interrupted.
+ */
+long memtest_run(ulong start, ulong size, int flags, ulong pattern,
+		 memtest_err_f *report);
+
+#endif /* __MEMTEST_H */
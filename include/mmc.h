@@ -49,6 +49,11 @@
 
 #define IS_SD(x) (x->version & SD_VERSION_SD)
 
+/* default upper limit of blocks read with one command, see struct mmc */
+#ifndef CONFIG_SYS_MMC_MAX_BLK_COUNT
+#define CONFIG_SYS_MMC_MAX_BLK_COUNT	65535
+#endif
+
 #define MMC_DATA_READ		1
 #define MMC_DATA_WRITE		2
 
@@ -258,6 +263,7 @@ struct mmc {
 	uint tran_speed;
 	uint read_bl_len;
 	uint write_bl_len;
+	uint b_max;		/* max. blocks per read command, 0: default */
 	u64 capacity;
 	block_dev_desc_t block_dev;
 	int (*send_cmd)(struct mmc *mmc,
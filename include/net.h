@@ -417,6 +417,52 @@ extern int	NetSendUDPPacket(uchar *ether, IPaddr_t dest, int dport, int sport, i
 /* Processes a received packet */
 extern void	NetReceive(volatile uchar *, int);
 
+#ifdef CONFIG_NET_DIRECT_RX
+/*
+ * Direct (zero-copy) receive.
+ *
+ * A protocol expecting a stream of in-order data frames (TFTP, NFS)
+ * announces where the payload of the frames to come belongs.  A driver
+ * able to scatter one frame over two buffers may then receive the first
+ * hdr_len bytes into a small buffer of its own and the rest straight to
+ * NetDirectRxAddr(n), and pass the frame on with NetReceiveSplit().
+ * When NetDirectRxAddr() returns NULL the driver must use a normal buffer.
+ *
+ * n must never be less than the number of frames which can arrive before
+ * the one landing in that buffer: guessing too high only costs a copy,
+ * guessing too low lets a later frame overwrite a payload already stored.
+ * For the same reason a driver must not hand out an address twice while
+ * the first buffer is still armed.
+ *
+ * Drivers have to (re)arm their descriptors only after NetReceiveSplit()
+ * returned, as the protocol moves the prediction while handling a frame.
+ * A frame whose first UDP payload word does not match (e.g. a TFTP ERROR
+ * instead of DATA, or the reply to another RPC) is glued together and
+ * handled like any other frame.
+ */
+typedef struct {
+	uchar	*addr;		/* payload destination of the next frame	*/
+	uchar	*end;		/* no payload may extend beyond this		*/
+	ushort	len;		/* payload bytes per frame			*/
+	ushort	hdr_len;	/* frame bytes in front of the payload		*/
+	ushort	port;		/* our UDP port of the stream			*/
+	ulong	match;		/* first payload word (host order) ...		*/
+	ulong	mask;		/* ... after masking it with this		*/
+} NetDirectRx_t;
+
+extern NetDirectRx_t	NetDirectRx;
+extern uchar		*NetRxData;	/* Payload of a direct frame, or NULL */
+
+/* Announce the payload destination; addr == NULL switches it off */
+extern void	NetSetDirectRx(uchar *addr, uchar *end, int len, int hdr_len,
+			       int port, ulong match, ulong mask);
+/* Payload destination for the n-th frame from now, or NULL */
+extern uchar	*NetDirectRxAddr(int n);
+/* Processes a received packet which is split in header and payload */
+extern void	NetReceiveSplit(volatile uchar *hdr, int hdr_len,
+				uchar *data, int data_len);
+#endif
+
 /*
  * The following functions are a bit ugly, but necessary to deal with
  * alignment restrictions on ARM.
@@ -108,6 +108,31 @@ void print_part (block_dev_desc_t *dev_desc);
 void  init_part (block_dev_desc_t *dev_desc);
 void dev_print(block_dev_desc_t *dev_desc);
 
+/* disk/blkcache.c */
+#ifdef CONFIG_BLOCK_CACHE
+struct blkcache_stats {
+	ulong	hits;		/* windows found in the cache		*/
+	ulong	misses;		/* windows read from the device		*/
+	ulong	bypass;		/* large requests passed straight through */
+	ulong	entries;	/* number of cache entries		*/
+	ulong	used;		/* entries currently holding data	*/
+	ulong	readahead;	/* blocks per entry			*/
+};
+
+ulong blkcache_read(block_dev_desc_t *dev_desc, lbaint_t start,
+		    lbaint_t blkcnt, void *buffer);
+void blkcache_invalidate(block_dev_desc_t *dev_desc);
+void blkcache_get_stats(struct blkcache_stats *s);
+void blkcache_reset_stats(void);
+#else
+static inline ulong blkcache_read(block_dev_desc_t *dev_desc, lbaint_t start,
+				  lbaint_t blkcnt, void *buffer)
+{
+	return dev_desc->block_read(dev_desc->dev, start, blkcnt, buffer);
+}
+
+static inline void blkcache_invalidate(block_dev_desc_t *dev_desc) {}
+#endif
 
 #ifdef CONFIG_MAC_PARTITION
 /* disk/part_mac.c */
@@ -44,10 +44,15 @@
 #define	SPI_LSB_FIRST	0x08			/* per-word bits-on-wire */
 #define	SPI_3WIRE	0x10			/* SI/SO signals shared */
 #define	SPI_LOOP	0x20			/* loopback mode */
+#define	SPI_RX_DUAL	0x40			/* receive on 2 wires */
+#define	SPI_RX_QUAD	0x80			/* receive on 4 wires */
+#define	SPI_TX_QUAD	0x100			/* transmit on 4 wires */
 
 /* SPI transfer flags */
 #define SPI_XFER_BEGIN	0x01			/* Assert CS before transfer */
 #define SPI_XFER_END	0x02			/* Deassert CS after transfer */
+#define SPI_XFER_DUAL	0x04			/* Clock bits on IO0-IO1 */
+#define SPI_XFER_QUAD	0x08			/* Clock bits on IO0-IO3 */
 
 /*-----------------------------------------------------------------------
  * Representation of a SPI slave, i.e. what we're communicating with.
@@ -142,11 +147,29 @@ void spi_release_bus(struct spi_slave *slave);
  *   din:	Pointer to a string of bits that will be filled in.
  *   flags:	A bitwise combination of SPI_XFER_* flags.
  *
+ * SPI_XFER_DUAL and SPI_XFER_QUAD clock "bitlen" bits in one direction
+ * over 2 or 4 data wires; they are only passed to controllers set up with
+ * the matching SPI_RX_* / SPI_TX_* mode flags.
+ *
  *   Returns: 0 on success, not 0 on failure
  */
 int  spi_xfer(struct spi_slave *slave, unsigned int bitlen, const void *dout,
 		void *din, unsigned long flags);
 
+/*-----------------------------------------------------------------------
+ * SPI bulk receive using DMA
+ *
+ * Provided by controller drivers that can move received data with DMA
+ * when CONFIG_SPI_XFER_DMA is defined. It is used instead of spi_xfer()
+ * for the data phase of SPI flash array reads, so it must accept any
+ * buffer alignment and length. The arguments are those of spi_xfer()
+ * without "dout"; idle bits are clocked out while receiving.
+ *
+ *   Returns: 0 on success, not 0 on failure
+ */
+int  spi_xfer_dma(struct spi_slave *slave, unsigned int bitlen, void *din,
+		unsigned long flags);
+
 /*-----------------------------------------------------------------------
  * Determine if a SPI chipselect is valid.
  * This function is provided by the board if the low-level SPI driver
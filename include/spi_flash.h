@@ -31,6 +31,11 @@ struct spi_flash_region {
 	unsigned int	size;
 };
 
+/* Multi-wire read modes, opcode and (command-address-data) wires */
+#define SPI_FLASH_RD_DUAL	0x01	/* 0x3b, 1-1-2 */
+#define SPI_FLASH_RD_QUAD	0x02	/* 0x6b, 1-1-4 */
+#define SPI_FLASH_RD_QUAD_IO	0x04	/* 0xeb, 1-4-4 */
+
 struct spi_flash {
 	struct spi_slave *spi;
 
@@ -38,6 +43,16 @@ struct spi_flash {
 
 	u32		size;
 
+	/*
+	 * SPI_FLASH_RD_* modes supported by the chip, and the one used by
+	 * spi_flash_cmd_read_fast() (0 for FAST_READ). The mode is chosen
+	 * by spi_flash_probe() from the SPI_RX_* / SPI_TX_* bits of the
+	 * SPI mode; quad_enable() sets the QE bit of chips that need it.
+	 */
+	u8		read_modes;
+	u8		read_mode;
+	int		(*quad_enable)(struct spi_flash *flash);
+
 	int		(*read)(struct spi_flash *flash, u32 offset,
 				size_t len, void *buf);
 	int		(*write)(struct spi_flash *flash, u32 offset,
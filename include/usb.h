@@ -153,6 +153,17 @@ void usb_event_poll(void);
 #error USB Lowlevel not defined
 #endif
 
+#ifdef CONFIG_USB_EHCI
+/*
+ * qTDs available to one EHCI transfer: SETUP and status stage plus
+ * the data stage, which needs one qTD per 16 KiB at worst.
+ */
+#ifndef CONFIG_SYS_USB_EHCI_MAX_QTD
+#define CONFIG_SYS_USB_EHCI_MAX_QTD	66
+#endif
+#define USB_EHCI_MAX_XFER_SIZE	((CONFIG_SYS_USB_EHCI_MAX_QTD - 2) * 16384)
+#endif
+
 #ifdef CONFIG_USB_STORAGE
 
 #define USB_MAX_STOR_DEV 5
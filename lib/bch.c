@@ -0,0 +1,595 @@
+/*
+ * Generic binary BCH encoding/decoding library
+ *
+ * Based on lib/bch.c from the Linux kernel:
+ * Copyright (C) 2011 Parrot S.A.
+ * Author: Ivan Djelic <ivan.djelic@parrot.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * A binary BCH code over GF(2^m) correcting t bit errors has a generator
+ * polynomial g(x), the product of the minimal polynomials of a^1, a^3, ...,
+ * a^(2t-1), whose degree is the number of ECC bits (at most m * t). The
+ * code is used shortened: the data bits are the highest coefficients of the
+ * codeword, the ECC is the remainder of data(x) * x^ecc_bits by g(x).
+ *
+ *  - Encoding divides 32 data bits at a time: the remainder contributions
+ *    of the four bytes of a word are looked up in four 256-entry tables,
+ *    so a word costs four lookups and four XORs per ECC word.
+ *  - Decoding computes the syndromes from the remainder of the received
+ *    codeword (the XOR of the read and the recomputed ECC), the error
+ *    locator polynomial with the Berlekamp-Massey algorithm and its roots
+ *    with a Chien search over the bit positions of the shortened codeword
+ *    only, using log/antilog tables for all GF(2^m) arithmetic.
+ *
+ * The ECC bits are kept left-aligned in 32-bit words: the MSB of the first
+ * word is the coefficient of x^(ecc_bits - 1), and the unused low bits of
+ * the last word are zero.
+ */
+
+#ifndef USE_HOSTCC
+#include <common.h>
+#include <malloc.h>
+#include <asm/errno.h>
+#else
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DIV_ROUND_UP(n,d)	(((n) + (d) - 1) / (d))
+
+static inline int fls(unsigned int x)
+{
+	int r = 0;
+
+	while (x) {
+		x >>= 1;
+		r++;
+	}
+	return r;
+}
+#endif /* USE_HOSTCC */
+#include <linux/bch.h>
+
+/* Default primitive polynomials, for m = BCH_MIN_M..BCH_MAX_M */
+static const unsigned int prim_poly_tab[] = {
+	0x25, 0x43, 0x83, 0x11d, 0x211, 0x409, 0x805, 0x1053, 0x201b,
+	0x402b, 0x8003,
+};
+
+/* Reduce v < 2n modulo n */
+static inline unsigned int mod_n(struct bch_control *bch, unsigned int v)
+{
+	return v >= bch->n ? v - bch->n : v;
+}
+
+static inline unsigned int gf_mul(struct bch_control *bch, unsigned int a,
+				  unsigned int b)
+{
+	if (!a || !b)
+		return 0;
+	return bch->a_pow_tab[mod_n(bch, bch->a_log_tab[a] +
+				    bch->a_log_tab[b])];
+}
+
+static inline unsigned int gf_div(struct bch_control *bch, unsigned int a,
+				  unsigned int b)
+{
+	if (!a)
+		return 0;
+	return bch->a_pow_tab[mod_n(bch, bch->a_log_tab[a] + bch->n -
+				    bch->a_log_tab[b])];
+}
+
+static void load_ecc(struct bch_control *bch, uint32_t *dst,
+		     const uint8_t *ecc)
+{
+	unsigned int i;
+
+	memset(dst, 0, bch->ecc_words * sizeof(uint32_t));
+	if (!ecc)
+		return;
+
+	for (i = 0; i < bch->ecc_bytes; i++)
+		dst[i / 4] |= ecc[i] << (24 - 8 * (i % 4));
+
+	/* Unused bits of the last ECC byte may hold anything */
+	if (bch->ecc_bits % 32)
+		dst[bch->ecc_words - 1] &= ~0u << (32 - bch->ecc_bits % 32);
+}
+
+static void store_ecc(struct bch_control *bch, uint8_t *ecc,
+		      const uint32_t *src)
+{
+	unsigned int i;
+
+	for (i = 0; i < bch->ecc_bytes; i++)
+		ecc[i] = src[i / 4] >> (24 - 8 * (i % 4));
+}
+
+/* r(x) = (r(x) * x^(8 * len) + data(x) * x^ecc_bits) mod g(x) */
+static void encode_data(struct bch_control *bch, const uint8_t *data,
+			unsigned int len)
+{
+	const unsigned int l = bch->ecc_words;
+	const uint32_t *t0 = bch->mod_tab, *t1 = t0 + 256 * l;
+	const uint32_t *t2 = t1 + 256 * l, *t3 = t2 + 256 * l;
+	const uint32_t *p0, *p1, *p2, *p3;
+	uint32_t *r = bch->ecc_buf, w;
+	unsigned int i;
+
+	while (len >= 4) {
+		w = r[0] ^ (data[0] << 24 | data[1] << 16 | data[2] << 8 |
+			    data[3]);
+		p0 = t0 + l * (w & 0xff);
+		p1 = t1 + l * ((w >> 8) & 0xff);
+		p2 = t2 + l * ((w >> 16) & 0xff);
+		p3 = t3 + l * (w >> 24);
+
+		for (i = 0; i < l - 1; i++)
+			r[i] = r[i + 1] ^ p0[i] ^ p1[i] ^ p2[i] ^ p3[i];
+		r[l - 1] = p0[l - 1] ^ p1[l - 1] ^ p2[l - 1] ^ p3[l - 1];
+
+		data += 4;
+		len -= 4;
+	}
+
+	/* The remaining bytes one at a time */
+	while (len--) {
+		p0 = t0 + l * ((r[0] >> 24) ^ *data++);
+
+		for (i = 0; i < l - 1; i++)
+			r[i] = (r[i] << 8 | r[i + 1] >> 24) ^ p0[i];
+		r[l - 1] = (r[l - 1] << 8) ^ p0[l - 1];
+	}
+}
+
+/**
+ * encode_bch - calculate the BCH ECC of a data buffer.
+ * @bch:	BCH control structure
+ * @data:	data to encode
+ * @len:	length of the data in bytes
+ * @ecc:	ECC buffer of @bch->ecc_bytes bytes
+ *
+ * The ECC of @data is calculated from the ECC already in @ecc, so @ecc must
+ * be zeroed for a new calculation. Data can be encoded in several chunks
+ * this way.
+ */
+void encode_bch(struct bch_control *bch, const uint8_t *data,
+		unsigned int len, uint8_t *ecc)
+{
+	load_ecc(bch, bch->ecc_buf, ecc);
+	encode_data(bch, data, len);
+	store_ecc(bch, ecc, bch->ecc_buf);
+}
+
+/*
+ * Compute the syndromes S_1..S_2t of the received codeword from its
+ * remainder by g(x). Returns zero if there are no errors.
+ */
+static int compute_syndromes(struct bch_control *bch, const uint32_t *rem)
+{
+	unsigned int i, j, w, bit, deg, e, step;
+	unsigned int *syn = bch->syn;
+	int nonzero = 0;
+
+	memset(syn, 0, 2 * bch->t * sizeof(*syn));
+
+	for (i = 0; i < bch->ecc_words; i++) {
+		w = rem[i];
+		while (w) {
+			bit = fls(w) - 1;
+			w &= ~(1u << bit);
+			/* Coefficient of x^deg, adds a^(j * deg) to S_j */
+			deg = bch->ecc_bits - 1 - (32 * i + 31 - bit);
+			e = deg;
+			step = mod_n(bch, 2 * deg);
+			/* Only odd syndromes, S_2j = S_j^2 */
+			for (j = 0; j < 2 * bch->t; j += 2) {
+				syn[j] ^= bch->a_pow_tab[e];
+				e = mod_n(bch, e + step);
+			}
+			nonzero = 1;
+		}
+	}
+
+	if (!nonzero)
+		return 0;
+
+	for (j = 1; j < 2 * bch->t; j += 2)
+		syn[j] = gf_mul(bch, syn[j / 2], syn[j / 2]);
+
+	return 1;
+}
+
+/*
+ * Berlekamp-Massey: find the error locator polynomial from the syndromes.
+ * Returns its degree, which is the number of errors, or -1 if there are
+ * more than t errors.
+ */
+static int compute_error_locator(struct bch_control *bch)
+{
+	const unsigned int t2 = 2 * bch->t;
+	unsigned int *c = bch->elp, *b = bch->elp_prev, *tmp = bch->elp_tmp;
+	unsigned int *syn = bch->syn;
+	unsigned int i, k, d, coef, prev_d = 1, shift = 1, len = 0;
+
+	memset(c, 0, (t2 + 1) * sizeof(*c));
+	memset(b, 0, (t2 + 1) * sizeof(*b));
+	c[0] = 1;
+	b[0] = 1;
+
+	for (k = 0; k < t2; k++) {
+		/* Discrepancy */
+		d = syn[k];
+		for (i = 1; i <= len; i++)
+			d ^= gf_mul(bch, c[i], syn[k - i]);
+
+		if (!d) {
+			shift++;
+			continue;
+		}
+
+		coef = gf_div(bch, d, prev_d);
+		if (2 * len <= k) {
+			memcpy(tmp, c, (t2 + 1) * sizeof(*c));
+			for (i = 0; i + shift <= t2; i++)
+				c[i + shift] ^= gf_mul(bch, coef, b[i]);
+			len = k + 1 - len;
+			memcpy(b, tmp, (t2 + 1) * sizeof(*b));
+			prev_d = d;
+			shift = 1;
+		} else {
+			for (i = 0; i + shift <= t2; i++)
+				c[i + shift] ^= gf_mul(bch, coef, b[i]);
+			shift++;
+		}
+	}
+
+	if (len > bch->t)
+		return -1;
+	for (i = len + 1; i <= t2; i++)
+		if (c[i])
+			return -1;
+	if (!c[len])
+		return -1;
+
+	return len;
+}
+
+/*
+ * Chien search: an error at the codeword bit of degree p is a root a^-p of
+ * the error locator. Only the nbits positions of the shortened codeword are
+ * tried, and the non-zero terms a^(log c_k - p * k) are updated
+ * incrementally. A single error is located directly. Returns the number of
+ * roots found, stored as degrees in @errloc.
+ */
+static int chien_search(struct bch_control *bch, int deg, unsigned int nbits,
+			unsigned int *errloc)
+{
+	int *e = bch->chien, *step = bch->chien + bch->t;
+	unsigned int p, v;
+	int i, k, nterms = 0, nroots = 0;
+
+	if (deg == 1) {
+		/* 1 + c_1 * a^-p = 0 */
+		p = bch->a_log_tab[bch->elp[1]];
+		if (p >= nbits)
+			return 0;
+		errloc[0] = p;
+		return 1;
+	}
+
+	for (k = 1; k <= deg; k++) {
+		if (!bch->elp[k])
+			continue;
+		e[nterms] = bch->a_log_tab[bch->elp[k]];
+		step[nterms++] = k;
+	}
+
+	for (p = 0; p < nbits; p++) {
+		v = 1;
+		for (i = 0; i < nterms; i++) {
+			v ^= bch->a_pow_tab[e[i]];
+			/* Next position: divide the term by a^k */
+			e[i] -= step[i];
+			if (e[i] < 0)
+				e[i] += bch->n;
+		}
+		if (!v) {
+			errloc[nroots++] = p;
+			if (nroots == deg)
+				break;
+		}
+	}
+
+	return nroots;
+}
+
+/**
+ * decode_bch - find the bit errors in a BCH codeword.
+ * @bch:	BCH control structure
+ * @data:	received data, only used if @calc_ecc is NULL
+ * @len:	length of the data in bytes
+ * @recv_ecc:	received ECC
+ * @calc_ecc:	ECC calculated from the received data, or NULL
+ * @errloc:	error locations are returned here, @bch->t entries
+ *
+ * Returns the number of bit errors, or %-EBADMSG if there are too many of
+ * them to be corrected, or %-EINVAL if @len is too large for the code. The
+ * erroneous bits are data[errloc[i] / 8] bit (errloc[i] % 8); locations of
+ * @len * 8 and above are bits of the ECC, at recv_ecc[errloc[i] / 8 - len].
+ */
+int decode_bch(struct bch_control *bch, const uint8_t *data, unsigned int len,
+	       const uint8_t *recv_ecc, const uint8_t *calc_ecc,
+	       unsigned int *errloc)
+{
+	unsigned int i, b, nbits = 8 * len + bch->ecc_bits;
+	uint32_t *rem = bch->ecc_buf2;
+	int deg, nerr;
+
+	if (nbits > bch->n)
+		return -EINVAL;
+
+	if (!calc_ecc) {
+		load_ecc(bch, bch->ecc_buf, NULL);
+		encode_data(bch, data, len);
+		memcpy(rem, bch->ecc_buf, bch->ecc_words * sizeof(uint32_t));
+	} else
+		load_ecc(bch, rem, calc_ecc);
+
+	load_ecc(bch, bch->ecc_buf, recv_ecc);
+	for (i = 0; i < bch->ecc_words; i++)
+		rem[i] ^= bch->ecc_buf[i];
+
+	if (!compute_syndromes(bch, rem))
+		return 0;
+
+	deg = compute_error_locator(bch);
+	if (deg <= 0)
+		return -EBADMSG;
+
+	nerr = chien_search(bch, deg, nbits, errloc);
+	if (nerr != deg)
+		return -EBADMSG;
+
+	/* Degrees to bit numbers, the first data bit has the highest degree */
+	for (i = 0; i < nerr; i++) {
+		b = nbits - 1 - errloc[i];
+		errloc[i] = (b & ~7) | (7 - (b & 7));
+	}
+
+	return nerr;
+}
+
+/**
+ * correct_bch - correct the data bits found by decode_bch().
+ * @bch:	BCH control structure
+ * @data:	received data
+ * @len:	length of the data in bytes
+ * @errloc:	error locations from decode_bch()
+ * @nerr:	number of errors from decode_bch()
+ *
+ * Errors in the ECC bits are left alone.
+ */
+void correct_bch(struct bch_control *bch, uint8_t *data, unsigned int len,
+		 unsigned int *errloc, int nerr)
+{
+	int i;
+
+	for (i = 0; i < nerr; i++)
+		if (errloc[i] < 8 * len)
+			data[errloc[i] / 8] ^= 1 << (errloc[i] % 8);
+}
+
+/* Fill the log/antilog tables, fails if the polynomial is not primitive */
+static int build_gf_tables(struct bch_control *bch, unsigned int poly)
+{
+	unsigned int i, x = 1;
+
+	if (fls(poly) - 1 != bch->m)
+		return -1;
+
+	memset(bch->a_log_tab, 0, (bch->n + 1) * sizeof(uint16_t));
+	for (i = 0; i < bch->n; i++) {
+		if (i && x == 1)
+			return -1;
+		bch->a_pow_tab[i] = x;
+		bch->a_log_tab[x] = i;
+		x <<= 1;
+		if (x & (1 << bch->m))
+			x ^= poly;
+	}
+	bch->a_pow_tab[bch->n] = 1;
+
+	return 0;
+}
+
+/*
+ * Compute the generator polynomial as the product of (x - a^r) over the
+ * roots r of the minimal polynomials of a^1, a^3, ..., a^(2t-1), and return
+ * its coefficients below x^ecc_bits left-aligned in @bch->ecc_words words.
+ */
+static uint32_t *build_generator(struct bch_control *bch)
+{
+	unsigned int i, j, r, deg = 0;
+	unsigned int *g;
+	uint8_t *roots;
+	uint32_t *genpoly = NULL;
+
+	roots = calloc(bch->n + 1, 1);
+	g = calloc(bch->m * bch->t + 1, sizeof(*g));
+	if (!roots || !g)
+		goto out;
+
+	/* Cyclotomic cosets of the odd powers */
+	for (i = 0; i < bch->t; i++) {
+		r = 2 * i + 1;
+		for (j = 0; j < bch->m; j++) {
+			roots[r] = 1;
+			r = mod_n(bch, 2 * r);
+		}
+	}
+
+	g[0] = 1;
+	for (r = 0; r < bch->n; r++) {
+		if (!roots[r])
+			continue;
+		/* g(x) *= (x + a^r) */
+		g[++deg] = 1;
+		for (j = deg - 1; j > 0; j--)
+			g[j] = g[j - 1] ^ gf_mul(bch, g[j], bch->a_pow_tab[r]);
+		g[0] = gf_mul(bch, g[0], bch->a_pow_tab[r]);
+	}
+
+	bch->ecc_bits = deg;
+	bch->ecc_bytes = DIV_ROUND_UP(deg, 8);
+	bch->ecc_words = DIV_ROUND_UP(deg, 32);
+
+	genpoly = calloc(bch->ecc_words, sizeof(uint32_t));
+	if (!genpoly)
+		goto out;
+
+	/* The coefficients are all 0 or 1; x^j is at bit deg - 1 - j */
+	for (j = 0; j < deg; j++)
+		if (g[j])
+			genpoly[(deg - 1 - j) / 32] |=
+				1u << (31 - (deg - 1 - j) % 32);
+out:
+	free(g);
+	free(roots);
+	return genpoly;
+}
+
+/*
+ * Fill the encoder tables by bitwise division: the entry of byte b in table
+ * k is (b * x^(ecc_bits + 8k)) mod g(x).
+ */
+static void build_mod_tables(struct bch_control *bch, const uint32_t *genpoly)
+{
+	const unsigned int l = bch->ecc_words;
+	unsigned int i, k, b, bit, fb;
+	uint32_t *r, w;
+
+	for (k = 0; k < 4; k++) {
+		for (b = 0; b < 256; b++) {
+			r = bch->mod_tab + (k * 256 + b) * l;
+			memset(r, 0, l * sizeof(uint32_t));
+			w = b << (8 * k);
+			for (bit = 32; bit-- > 0; ) {
+				fb = ((w >> bit) ^ (r[0] >> 31)) & 1;
+				for (i = 0; i < l - 1; i++)
+					r[i] = r[i] << 1 | r[i + 1] >> 31;
+				r[l - 1] <<= 1;
+				if (fb)
+					for (i = 0; i < l; i++)
+						r[i] ^= genpoly[i];
+			}
+		}
+	}
+}
+
+/**
+ * init_bch - initialize a BCH encoder/decoder.
+ * @m:		Galois field order, between BCH_MIN_M and BCH_MAX_M
+ * @t:		number of correctable bit errors
+ * @prim_poly:	primitive polynomial of GF(2^m), or 0 for the default one
+ *
+ * A code over GF(2^m) protects up to 2^m - 1 - m * t bits of data, e.g.
+ * m = 13 for 512-byte and m = 14 for 1024-byte blocks. The number of ECC
+ * bytes per block is returned in the ecc_bytes field. Returns the BCH
+ * control structure, or NULL in case of invalid parameters or when out of
+ * memory.
+ */
+struct bch_control *init_bch(int m, int t, unsigned int prim_poly)
+{
+	struct bch_control *bch;
+	uint32_t *genpoly = NULL;
+	unsigned int l;
+
+	if (m < BCH_MIN_M || m > BCH_MAX_M || t < 1)
+		return NULL;
+	if (m * t >= (1 << m) - 1)
+		return NULL;
+	if (!prim_poly)
+		prim_poly = prim_poly_tab[m - BCH_MIN_M];
+
+	bch = calloc(1, sizeof(*bch));
+	if (!bch)
+		return NULL;
+
+	bch->m = m;
+	bch->t = t;
+	bch->n = (1 << m) - 1;
+	bch->a_pow_tab = malloc((bch->n + 1) * sizeof(uint16_t));
+	bch->a_log_tab = malloc((bch->n + 1) * sizeof(uint16_t));
+	bch->syn = malloc(2 * t * sizeof(unsigned int));
+	bch->elp = malloc((2 * t + 1) * sizeof(unsigned int));
+	bch->elp_prev = malloc((2 * t + 1) * sizeof(unsigned int));
+	bch->elp_tmp = malloc((2 * t + 1) * sizeof(unsigned int));
+	bch->chien = malloc(2 * t * sizeof(int));
+	if (!bch->a_pow_tab || !bch->a_log_tab || !bch->syn || !bch->elp ||
+	    !bch->elp_prev || !bch->elp_tmp || !bch->chien)
+		goto fail;
+
+	if (build_gf_tables(bch, prim_poly))
+		goto fail;
+
+	genpoly = build_generator(bch);
+	if (!genpoly)
+		goto fail;
+
+	l = bch->ecc_words;
+	bch->mod_tab = malloc(4 * 256 * l * sizeof(uint32_t));
+	bch->ecc_buf = malloc(l * sizeof(uint32_t));
+	bch->ecc_buf2 = malloc(l * sizeof(uint32_t));
+	if (!bch->mod_tab || !bch->ecc_buf || !bch->ecc_buf2)
+		goto fail;
+
+	build_mod_tables(bch, genpoly);
+	free(genpoly);
+
+	return bch;
+
+fail:
+	free(genpoly);
+	free_bch(bch);
+	return NULL;
+}
+
+/**
+ * free_bch - free a BCH control structure.
+ * @bch:	BCH control structure from init_bch(), may be NULL
+ */
+void free_bch(struct bch_control *bch)
+{
+	if (!bch)
+		return;
+
+	free(bch->a_pow_tab);
+	free(bch->a_log_tab);
+	free(bch->mod_tab);
+	free(bch->ecc_buf);
+	free(bch->ecc_buf2);
+	free(bch->syn);
+	free(bch->elp);
+	free(bch->elp_prev);
+	free(bch->elp_tmp);
+	free(bch->chien);
+	free(bch);
+}
@@ -0,0 +1,406 @@
+/*
+ * (C) Copyright 2010
+ * The U-Boot Authors
+ *
+ * Fast memory test
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The tests sweep the region with 64-bit accesses, unrolled four at a
+ * time, so a cache line is written or read in one go instead of word
+ * by word through a function of its own for every pattern:
+ *
+ *  - data line:	walking 1 and 0 through a single double word
+ *  - address line:	aliasing of the power-of-two offsets
+ *  - walking ones:	word i holds 1 << (i % 64), then the inverse
+ *  - moving inv.:	0x55.. up, then read/invert up and down (March)
+ *  - address:		every word holds its address, then the inverse
+ *
+ * A pattern given by the caller replaces 0x55.. and is XORed into the
+ * addresses, so repeated runs can use different data.
+ *
+ * With CONFIG_SYS_MEMTEST_DCACHE the data cache is enabled while
+ * testing, and every chunk is flushed and invalidated after it was
+ * touched so the next sweep reads the memory, not the cache.
+ */
+
+#include <common.h>
+#include <memtest.h>
+#include <watchdog.h>
+
+typedef volatile u64 vu64;
+
+#define ROTL(x, r)	(((x) << (r)) | ((x) >> ((64 - (r)) & 63)))
+
+#define MT_WRITE	0	/* store pattern */
+#define MT_CHECK	1	/* compare with pattern */
+#define MT_INVERT	2	/* compare with pattern, store inverse */
+#define MT_INVERT_DOWN	3	/* the same, from the top down */
+#define MT_ADDR_WRITE	4	/* store address ^ pattern */
+#define MT_ADDR_CHECK	5	/* compare with address ^ pattern */
+
+struct memtest {
+	vu64		*base;
+	ulong		words;
+	int		flags;
+	u64		pattern;	/* moving inv. / address XOR */
+	memtest_err_f	*report;
+	long		errors;
+	const char	*name;		/* current test */
+	ulong		pos, total;	/* progress, in chunks */
+	int		pct;
+};
+
+/* Returns 1 if the test has to stop */
+static int mt_error(struct memtest *mt, vu64 *p, u64 expected, u64 actual)
+{
+	mt->errors++;
+	if (mt->report)
+		mt->report(mt->name, (ulong)p, expected, actual);
+	return (mt->flags & MEMTEST_FIRST_ERROR) != 0;
+}
+
+static int mt_check4(struct memtest *mt, vu64 *p, u64 e0, u64 e1, u64 e2,
+		     u64 e3, u64 v0, u64 v1, u64 v2, u64 v3)
+{
+	int stop = 0;
+
+	if (v0 != e0)
+		stop |= mt_error(mt, p, e0, v0);
+	if (v1 != e1)
+		stop |= mt_error(mt, p + 1, e1, v1);
+	if (v2 != e2)
+		stop |= mt_error(mt, p + 2, e2, v2);
+	if (v3 != e3)
+		stop |= mt_error(mt, p + 3, e3, v3);
+	return stop;
+}
+
+static inline u64 mt_addr(vu64 *p)
+{
+	u64 a = (ulong)p;
+
+	return a ^ (~a << 32);
+}
+
+/*
+ * One operation over n words (a multiple of 4) at p.  The pattern of
+ * word i is pat rotated left by i * rot bits.
+ */
+static int mt_chunk(struct memtest *mt, int op, vu64 *p, ulong n,
+		    u64 pat, int rot)
+{
+	u64 e0, e1, e2, e3, v0, v1, v2, v3;
+
+	switch (op) {
+	case MT_WRITE:
+		for (; n; n -= 4, p += 4) {
+			p[0] = pat;
+			pat = ROTL(pat, rot);
+			p[1] = pat;
+			pat = ROTL(pat, rot);
+			p[2] = pat;
+			pat = ROTL(pat, rot);
+			p[3] = pat;
+			pat = ROTL(pat, rot);
+		}
+		break;
+
+	case MT_CHECK:
+	case MT_INVERT:
+		for (; n; n -= 4, p += 4) {
+			e0 = pat;
+			e1 = ROTL(e0, rot);
+			e2 = ROTL(e1, rot);
+			e3 = ROTL(e2, rot);
+			pat = ROTL(e3, rot);
+			if (op == MT_INVERT) {
+				v0 = p[0];
+				p[0] = ~e0;
+				v1 = p[1];
+				p[1] = ~e1;
+				v2 = p[2];
+				p[2] = ~e2;
+				v3 = p[3];
+				p[3] = ~e3;
+			} else {
+				v0 = p[0];
+				v1 = p[1];
+				v2 = p[2];
+				v3 = p[3];
+			}
+			if (((v0 ^ e0) | (v1 ^ e1) | (v2 ^ e2) | (v3 ^ e3)) &&
+			    mt_check4(mt, p, e0, e1, e2, e3, v0, v1, v2, v3))
+				return 1;
+		}
+		break;
+
+	case MT_INVERT_DOWN:	/* fixed patterns only */
+		for (p += n; n; n -= 4) {
+			p -= 4;
+			v3 = p[3];
+			p[3] = ~pat;
+			v2 = p[2];
+			p[2] = ~pat;
+			v1 = p[1];
+			p[1] = ~pat;
+			v0 = p[0];
+			p[0] = ~pat;
+			if (((v0 ^ pat) | (v1 ^ pat) | (v2 ^ pat) | (v3 ^ pat)) &&
+			    mt_check4(mt, p, pat, pat, pat, pat, v0, v1, v2, v3))
+				return 1;
+		}
+		break;
+
+	case MT_ADDR_WRITE:
+		for (; n; n -= 4, p += 4) {
+			p[0] = mt_addr(p) ^ pat;
+			p[1] = mt_addr(p + 1) ^ pat;
+			p[2] = mt_addr(p + 2) ^ pat;
+			p[3] = mt_addr(p + 3) ^ pat;
+		}
+		break;
+
+	case MT_ADDR_CHECK:
+		for (; n; n -= 4, p += 4) {
+			e0 = mt_addr(p) ^ pat;
+			e1 = mt_addr(p + 1) ^ pat;
+			e2 = mt_addr(p + 2) ^ pat;
+			e3 = mt_addr(p + 3) ^ pat;
+			v0 = p[0];
+			v1 = p[1];
+			v2 = p[2];
+			v3 = p[3];
+			if (((v0 ^ e0) | (v1 ^ e1) | (v2 ^ e2) | (v3 ^ e3)) &&
+			    mt_check4(mt, p, e0, e1, e2, e3, v0, v1, v2, v3))
+				return 1;
+		}
+		break;
+	}
+	return 0;
+}
+
+static void mt_progress(struct memtest *mt)
+{
+	int pct;
+
+	if (!(mt->flags & MEMTEST_PROGRESS))
+		return;
+
+	pct = mt->total ? mt->pos * 100 / mt->total : 0;
+	if (pct != mt->pct || mt->pos == 0) {
+		mt->pct = pct;
+		printf("\r  %-16s%3d%%", mt->name, pct);
+	}
+}
+
+/* Start a test of 'sweeps' passes over the region */
+static void mt_begin(struct memtest *mt, const char *name, int sweeps)
+{
+	mt->name = name;
+	mt->pos = 0;
+	mt->total = sweeps * ((mt->words * 8 + MEMTEST_CHUNK - 1) /
+			      MEMTEST_CHUNK);
+	mt_progress(mt);
+}
+
+/* Returns 1 if the test has to stop */
+static int mt_chunk_done(struct memtest *mt, vu64 *p, ulong n)
+{
+#ifdef CONFIG_SYS_MEMTEST_DCACHE
+	flush_dcache_range((ulong)p, (ulong)(p + n));
+	invalidate_dcache_range((ulong)p, (ulong)(p + n));
+#endif
+	WATCHDOG_RESET();
+
+	mt->pos++;
+	mt_progress(mt);
+
+	return (mt->flags & MEMTEST_CTRLC) && ctrlc();
+}
+
+/* One operation over the whole region, chunk by chunk */
+static int mt_sweep(struct memtest *mt, int op, u64 pat, int rot)
+{
+	ulong chunk = MEMTEST_CHUNK / sizeof(u64);
+	ulong i, n;
+
+	if (op == MT_INVERT_DOWN) {
+		for (i = mt->words; i > 0; i -= n) {
+			n = (i - 1) % chunk + 1;
+			if (mt_chunk(mt, op, mt->base + i - n, n, pat, rot) ||
+			    mt_chunk_done(mt, mt->base + i - n, n))
+				return 1;
+		}
+		return 0;
+	}
+
+	for (i = 0; i < mt->words; i += n) {
+		n = min(chunk, mt->words - i);
+		/* chunks start at a multiple of 64 words: same pattern */
+		if (mt_chunk(mt, op, mt->base + i, n, pat, rot) ||
+		    mt_chunk_done(mt, mt->base + i, n))
+			return 1;
+	}
+	return 0;
+}
+
+static int mt_dataline(struct memtest *mt)
+{
+	vu64 *p = mt->base;
+	vu64 *other = mt->base + mt->words - 1;
+	u64 val, readback;
+	int i;
+
+	for (i = 0; i < 64; i++) {
+		val = 1ULL << i;
+		*p = val;
+		*other = ~val;	/* clear the test data off of the bus */
+		readback = *p;
+		if (readback != val && mt_error(mt, p, val, readback))
+			return 1;
+
+		*p = ~val;
+		*other = val;
+		readback = *p;
+		if (readback != ~val && mt_error(mt, p, ~val, readback))
+			return 1;
+	}
+	return 0;
+}
+
+static int mt_addrline(struct memtest *mt)
+{
+	const u64 pattern = 0xaaaaaaaaaaaaaaaaULL;
+	const u64 anti_pattern = 0x5555555555555555ULL;
+	vu64 *p = mt->base;
+	ulong offset, test;
+	u64 temp;
+
+	for (offset = 1; offset < mt->words; offset <<= 1)
+		p[offset] = pattern;
+	p[0] = pattern;
+
+	/* test 0 finds bits stuck high, the others stuck low or shorted */
+	for (test = 0; test < mt->words; test = test ? test << 1 : 1) {
+		p[test] = anti_pattern;
+
+		for (offset = 0; offset < mt->words;
+		     offset = offset ? offset << 1 : 1) {
+			if (offset == test)
+				continue;
+			temp = p[offset];
+			if (temp != pattern &&
+			    mt_error(mt, p + offset, pattern, temp))
+				return 1;
+		}
+
+		temp = p[test];
+		if (temp != anti_pattern &&
+		    mt_error(mt, p + test, anti_pattern, temp))
+			return 1;
+		p[test] = pattern;
+	}
+	return 0;
+}
+
+static int mt_run(struct memtest *mt)
+{
+	const u64 mi = mt->pattern ? mt->pattern : 0x5555555555555555ULL;
+
+	if (mt->flags & MEMTEST_DATALINE) {
+		mt_begin(mt, "data line", 0);
+		if (mt_dataline(mt))
+			return 1;
+	}
+
+	if (mt->flags & MEMTEST_ADDRLINE) {
+		mt_begin(mt, "address line", 0);
+		if (mt_addrline(mt))
+			return 1;
+	}
+
+	if (mt->flags & MEMTEST_WALK) {
+		mt_begin(mt, "walking ones", 4);
+		if (mt_sweep(mt, MT_WRITE, 1, 1) ||
+		    mt_sweep(mt, MT_CHECK, 1, 1) ||
+		    mt_sweep(mt, MT_WRITE, ~1ULL, 1) ||
+		    mt_sweep(mt, MT_CHECK, ~1ULL, 1))
+			return 1;
+	}
+
+	if (mt->flags & MEMTEST_MOVINV) {
+		mt_begin(mt, "moving inv.", 4);
+		if (mt_sweep(mt, MT_WRITE, mi, 0) ||
+		    mt_sweep(mt, MT_INVERT, mi, 0) ||
+		    mt_sweep(mt, MT_INVERT_DOWN, ~mi, 0) ||
+		    mt_sweep(mt, MT_CHECK, mi, 0))
+			return 1;
+	}
+
+	if (mt->flags & MEMTEST_ADDR) {
+		mt_begin(mt, "address", 4);
+		if (mt_sweep(mt, MT_ADDR_WRITE, mt->pattern, 0) ||
+		    mt_sweep(mt, MT_ADDR_CHECK, mt->pattern, 0) ||
+		    mt_sweep(mt, MT_ADDR_WRITE, ~mt->pattern, 0) ||
+		    mt_sweep(mt, MT_ADDR_CHECK, ~mt->pattern, 0))
+			return 1;
+	}
+
+	return 0;
+}
+
+long memtest_run(ulong start, ulong size, int flags, ulong pattern,
+		 memtest_err_f *report)
+{
+	struct memtest mt;
+	ulong end = (start + size) & ~31UL;
+	int stop;
+#ifdef CONFIG_SYS_MEMTEST_DCACHE
+	int dcache = dcache_status();
+
+	if (!dcache)
+		dcache_enable();
+#endif
+
+	start = (start + 31) & ~31UL;
+
+	memset(&mt, 0, sizeof(mt));
+	mt.base = (vu64 *)start;
+	mt.words = end > start ? (end - start) / sizeof(u64) : 0;
+	mt.flags = flags;
+	mt.pattern = (u64)(u32)pattern * 0x100000001ULL;
+	mt.report = report;
+
+	stop = mt.words ? mt_run(&mt) : 0;
+
+	if (flags & MEMTEST_PROGRESS)
+		printf("\r%24s\r", "");
+
+#ifdef CONFIG_SYS_MEMTEST_DCACHE
+	if (!dcache)
+		dcache_disable();
+#endif
+
+	if (stop && !(flags & MEMTEST_FIRST_ERROR && mt.errors))
+		return -1;	/* interrupted */
+	return mt.errors;
+}
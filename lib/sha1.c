@@ -35,6 +35,7 @@
 #else
 #include <string.h>
 #endif /* USE_HOSTCC */
+#include <compiler.h>
 #include <watchdog.h>
 #include "sha1.h"
 
@@ -58,6 +59,26 @@
 }
 #endif
 
+/*
+ * Fetch the 16 message words of a block.  Word aligned blocks (the
+ * context buffer and, normally, the caller's data) are read a word
+ * at a time, which needs no byte swapping at all on big endian CPUs.
+ */
+static void sha1_get_block (uint32_t W[16], const unsigned char *data)
+{
+	int i;
+
+	if (((unsigned long) data & 3) == 0) {
+		const uint32_t *p = (const uint32_t *) data;
+
+		for (i = 0; i < 16; i++)
+			W[i] = be32_to_cpu (p[i]);
+	} else {
+		for (i = 0; i < 16; i++)
+			GET_UINT32_BE (W[i], data, 4 * i);
+	}
+}
+
 /*
  * SHA-1 context setup
  */
@@ -75,26 +96,11 @@ void sha1_starts (sha1_context * ctx)
 
 static void sha1_process (sha1_context * ctx, unsigned char data[64])
 {
-	unsigned long temp, W[16], A, B, C, D, E;
-
-	GET_UINT32_BE (W[0], data, 0);
-	GET_UINT32_BE (W[1], data, 4);
-	GET_UINT32_BE (W[2], data, 8);
-	GET_UINT32_BE (W[3], data, 12);
-	GET_UINT32_BE (W[4], data, 16);
-	GET_UINT32_BE (W[5], data, 20);
-	GET_UINT32_BE (W[6], data, 24);
-	GET_UINT32_BE (W[7], data, 28);
-	GET_UINT32_BE (W[8], data, 32);
-	GET_UINT32_BE (W[9], data, 36);
-	GET_UINT32_BE (W[10], data, 40);
-	GET_UINT32_BE (W[11], data, 44);
-	GET_UINT32_BE (W[12], data, 48);
-	GET_UINT32_BE (W[13], data, 52);
-	GET_UINT32_BE (W[14], data, 56);
-	GET_UINT32_BE (W[15], data, 60);
-
-#define S(x,n)	((x << n) | ((x & 0xFFFFFFFF) >> (32 - n)))
+	uint32_t temp, W[16], A, B, C, D, E;
+
+	sha1_get_block (W, data);
+
+#define S(x,n)	((x << n) | (x >> (32 - n)))
 
 #define R(t) (						\
 	temp = W[(t -  3) & 0x0F] ^ W[(t - 8) & 0x0F] ^	\
@@ -21,6 +21,7 @@
 #ifndef USE_HOSTCC
 #include <common.h>
 #endif /* USE_HOSTCC */
+#include <compiler.h>
 #include <watchdog.h>
 #include <linux/string.h>
 #include <sha256.h>
@@ -45,6 +46,25 @@
 }
 #endif
 
+/*
+ * Fetch the 16 message words of a block, a word at a time if the
+ * block is word aligned (see sha1_get_block() in sha1.c).
+ */
+static void sha256_get_block(uint32_t W[16], const uint8_t *data)
+{
+	int i;
+
+	if (((unsigned long) data & 3) == 0) {
+		const uint32_t *p = (const uint32_t *) data;
+
+		for (i = 0; i < 16; i++)
+			W[i] = be32_to_cpu(p[i]);
+	} else {
+		for (i = 0; i < 16; i++)
+			GET_UINT32_BE(W[i], data, 4 * i);
+	}
+}
+
 void sha256_starts(sha256_context * ctx)
 {
 	ctx->total[0] = 0;
@@ -66,24 +86,9 @@ void sha256_process(sha256_context * ctx, uint8_t data[64])
 	uint32_t W[64];
 	uint32_t A, B, C, D, E, F, G, H;
 
-	GET_UINT32_BE(W[0], data, 0);
-	GET_UINT32_BE(W[1], data, 4);
-	GET_UINT32_BE(W[2], data, 8);
-	GET_UINT32_BE(W[3], data, 12);
-	GET_UINT32_BE(W[4], data, 16);
-	GET_UINT32_BE(W[5], data, 20);
-	GET_UINT32_BE(W[6], data, 24);
-	GET_UINT32_BE(W[7], data, 28);
-	GET_UINT32_BE(W[8], data, 32);
-	GET_UINT32_BE(W[9], data, 36);
-	GET_UINT32_BE(W[10], data, 40);
-	GET_UINT32_BE(W[11], data, 44);
-	GET_UINT32_BE(W[12], data, 48);
-	GET_UINT32_BE(W[13], data, 52);
-	GET_UINT32_BE(W[14], data, 56);
-	GET_UINT32_BE(W[15], data, 60);
-
-#define SHR(x,n) ((x & 0xFFFFFFFF) >> n)
+	sha256_get_block(W, data);
+
+#define SHR(x,n) (x >> n)
 #define ROTR(x,n) (SHR(x,n) | (x << (32 - n)))
 
 #define S0(x) (ROTR(x, 7) ^ ROTR(x,18) ^ SHR(x, 3))
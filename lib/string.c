@@ -19,6 +19,27 @@
 #include <linux/string.h>
 #include <linux/ctype.h>
 #include <malloc.h>
+#include <asm/byteorder.h>
+
+/*
+ * The generic memset()/memcpy()/memmove() below work a word at a time
+ * and handle eight words (a typical cache line) per loop iteration.
+ */
+#define WSIZE		sizeof(unsigned long)
+#define WMASK		(WSIZE - 1)
+#define WBLOCK		(8 * WSIZE)
+
+/*
+ * Merge two aligned source words into one word of a source stream
+ * which is "shift" bits off the word alignment.
+ */
+#if defined(__BIG_ENDIAN)
+#define MERGE(w0, w1, shift) \
+	(((w0) << (shift)) | ((w1) >> (8 * WSIZE - (shift))))
+#else
+#define MERGE(w0, w1, shift) \
+	(((w0) >> (shift)) | ((w1) << (8 * WSIZE - (shift))))
+#endif
 
 
 #if 0 /* not used - was: #ifndef __HAVE_ARCH_STRNICMP */
@@ -403,24 +424,37 @@ char *strswab(const char *s)
  */
 void * memset(void * s,int c,size_t count)
 {
-	unsigned long *sl = (unsigned long *) s;
+	unsigned long *sl;
 	unsigned long cl = 0;
-	char *s8;
+	char *s8 = (char *)s;
 	int i;
 
-	/* do it one word at a time (32 bits or 64 bits) while possible */
-	if ( ((ulong)s & (sizeof(*sl) - 1)) == 0) {
-		for (i = 0; i < sizeof(*sl); i++) {
+	if (count >= WSIZE) {
+		/* fill 8 bits at a time up to the first word boundary */
+		while ((ulong)s8 & WMASK) {
+			*s8++ = c;
+			count--;
+		}
+
+		/* then do it one word at a time (32 bits or 64 bits) */
+		for (i = 0; i < WSIZE; i++) {
 			cl <<= 8;
 			cl |= c & 0xff;
 		}
-		while (count >= sizeof(*sl)) {
+		sl = (unsigned long *)s8;
+		while (count >= WBLOCK) {
+			sl[0] = cl; sl[1] = cl; sl[2] = cl; sl[3] = cl;
+			sl[4] = cl; sl[5] = cl; sl[6] = cl; sl[7] = cl;
+			sl += 8;
+			count -= WBLOCK;
+		}
+		while (count >= WSIZE) {
 			*sl++ = cl;
-			count -= sizeof(*sl);
+			count -= WSIZE;
 		}
+		s8 = (char *)sl;
 	}
 	/* fill 8 bits at a time */
-	s8 = (char *)sl;
 	while (count--)
 		*s8++ = c;
 
@@ -464,19 +498,58 @@ char * bcopy(const char * src, char * dest, int count)
  */
 void * memcpy(void *dest, const void *src, size_t count)
 {
-	unsigned long *dl = (unsigned long *)dest, *sl = (unsigned long *)src;
-	char *d8, *s8;
+	unsigned long *dl, *sl;
+	unsigned long w0, w1;
+	char *d8 = (char *)dest, *s8 = (char *)src;
+	int shift;
+
+	if (count < WSIZE)
+		goto bytes;
 
-	/* while all data is aligned (common case), copy a word at a time */
-	if ( (((ulong)dest | (ulong)src) & (sizeof(*dl) - 1)) == 0) {
-		while (count >= sizeof(*dl)) {
+	/* copy single bytes until the destination is word aligned */
+	while ((ulong)d8 & WMASK) {
+		*d8++ = *s8++;
+		count--;
+	}
+	dl = (unsigned long *)d8;
+
+	if (((ulong)s8 & WMASK) == 0) {
+		/* both aligned (common case), copy whole words */
+		sl = (unsigned long *)s8;
+		while (count >= WBLOCK) {
+			dl[0] = sl[0]; dl[1] = sl[1]; dl[2] = sl[2]; dl[3] = sl[3];
+			dl[4] = sl[4]; dl[5] = sl[5]; dl[6] = sl[6]; dl[7] = sl[7];
+			dl += 8;
+			sl += 8;
+			count -= WBLOCK;
+		}
+		while (count >= WSIZE) {
 			*dl++ = *sl++;
-			count -= sizeof(*dl);
+			count -= WSIZE;
+		}
+		s8 = (char *)sl;
+	} else if (count >= WSIZE) {
+		/*
+		 * Source and destination alignment differ: read aligned
+		 * source words and shift the bytes into place.  The last
+		 * word read never reaches past the aligned word holding
+		 * the last source byte we need.
+		 */
+		shift = 8 * ((ulong)s8 & WMASK);
+		sl = (unsigned long *)((ulong)s8 & ~WMASK);
+		w0 = *sl++;
+		while (count >= WSIZE) {
+			w1 = *sl++;
+			*dl++ = MERGE(w0, w1, shift);
+			w0 = w1;
+			count -= WSIZE;
+			s8 += WSIZE;
 		}
 	}
-	/* copy the reset one byte at a time */
 	d8 = (char *)dl;
-	s8 = (char *)sl;
+
+bytes:
+	/* copy the rest one byte at a time */
 	while (count--)
 		*d8++ = *s8++;
 
@@ -495,20 +568,38 @@ void * memcpy(void *dest, const void *src, size_t count)
  */
 void * memmove(void * dest,const void *src,size_t count)
 {
+	unsigned long *dl, *sl;
 	char *tmp, *s;
 
-	if (dest <= src) {
-		tmp = (char *) dest;
-		s = (char *) src;
-		while (count--)
-			*tmp++ = *s++;
-		}
-	else {
-		tmp = (char *) dest + count;
-		s = (char *) src + count;
-		while (count--)
+	/*
+	 * A forward copy is fine unless the destination starts inside
+	 * the source.  memcpy() above never writes a word before having
+	 * read the source words it covers, so it may be used for this.
+	 */
+	if (dest <= src || (char *)dest >= (char *)src + count)
+		return memcpy(dest, src, count);
+
+	tmp = (char *) dest + count;
+	s = (char *) src + count;
+
+	/* same alignment: copy backwards a word at a time */
+	if ((((ulong)tmp ^ (ulong)s) & WMASK) == 0 && count >= WSIZE) {
+		while ((ulong)tmp & WMASK) {
 			*--tmp = *--s;
+			count--;
+		}
+		dl = (unsigned long *)tmp;
+		sl = (unsigned long *)s;
+		while (count >= WSIZE) {
+			*--dl = *--sl;
+			count -= WSIZE;
 		}
+		tmp = (char *)dl;
+		s = (char *)sl;
+	}
+
+	while (count--)
+		*--tmp = *--s;
 
 	return dest;
 }
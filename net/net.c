@@ -78,6 +78,7 @@
 #include <watchdog.h>
 #include <command.h>
 #include <net.h>
+#include <bootstage.h>
 #include "bootp.h"
 #include "tftp.h"
 #include "rarp.h"
@@ -187,6 +188,13 @@ volatile uchar	PktBuf[(PKTBUFSRX+1) * PKTSIZE_ALIGN + PKTALIGN];
 
 volatile uchar *NetRxPackets[PKTBUFSRX]; /* Receive packets			*/
 
+#ifdef CONFIG_NET_DIRECT_RX
+NetDirectRx_t	NetDirectRx;		/* Where the next payload is expected	*/
+uchar		*NetRxData;		/* Payload of the current direct frame	*/
+					/* Split frames which are not direct	*/
+static uchar	NetRxSplitBuf[PKTSIZE_ALIGN] __attribute__((aligned(PKTALIGN)));
+#endif
+
 static rxhand_f *packetHandler;		/* Current RX packet handler		*/
 static thand_f *timeHandler;		/* Current timeout handler		*/
 static ulong	timeStart;		/* Time base value			*/
@@ -321,6 +329,11 @@ NetLoop(proto_t protocol)
 	NetArpWaitTxPacket = NULL;
 	NetTxPacket = NULL;
 	NetTryCount = 1;
+	bootstage_mark("net_start");
+#ifdef CONFIG_NET_DIRECT_RX
+	/* no stale predictions while the driver sets up its descriptors */
+	NetSetDirectRx(NULL, NULL, 0, 0, 0, 0, 0);
+#endif
 
 	if (!NetTxPacket) {
 		int	i;
@@ -522,6 +535,7 @@ restart:
 			goto restart;
 
 		case NETLOOP_SUCCESS:
+			bootstage_mark("net_done");
 			if (NetBootFileXferSize > 0) {
 				char buf[20];
 				printf("Bytes transferred = %ld (%lx hex)\n",
@@ -615,6 +629,10 @@ void
 NetSetHandler(rxhand_f * f)
 {
 	packetHandler = f;
+#ifdef CONFIG_NET_DIRECT_RX
+	/* predictions belong to the old handler */
+	NetSetDirectRx(NULL, NULL, 0, 0, 0, 0, 0);
+#endif
 }
 
 
@@ -1133,12 +1151,9 @@ static void CDPStart(void)
 /*
  * MAXDEFRAG, above, is chosen in the config file and  is real data
  * so we need to add the NFS overhead, which is more than TFTP.
- * To use sizeof in the internal unnamed structures, we need a real
- * instance (can't do "sizeof(struct rpc_t.u.reply))", unfortunately).
- * The compiler doesn't complain nor allocates the actual structure
+ * The NFSv3 READ reply has the biggest header.
  */
-static struct rpc_t rpc_specimen;
-#define IP_PKTSIZE (CONFIG_NET_MAXDEFRAG + sizeof(rpc_specimen.u.reply))
+#define IP_PKTSIZE (CONFIG_NET_MAXDEFRAG + NFS3_READ_HDR_SIZE)
 
 #define IP_MAXUDP (IP_PKTSIZE - IP_HDR_SIZE_NO_UDP)
 
@@ -1639,6 +1654,13 @@ NetReceive(volatile uchar * inpkt, int len)
 			while (sumlen > 1) {
 				ushort sumdata;
 
+#ifdef CONFIG_NET_DIRECT_RX
+				/* the payload is not behind the header */
+				if (NetRxData && (uchar *)sumptr ==
+				    (uchar *)inpkt + NetDirectRx.hdr_len)
+					sumptr = (ushort *)NetRxData;
+#endif
+
 				sumdata = *sumptr++;
 				xsum += ntohs(sumdata);
 				sumlen -= 2;
@@ -1679,6 +1701,75 @@ NetReceive(volatile uchar * inpkt, int len)
 	}
 }
 
+#ifdef CONFIG_NET_DIRECT_RX
+void
+NetSetDirectRx(uchar *addr, uchar *end, int len, int hdr_len, int port,
+	       ulong match, ulong mask)
+{
+	/* the UDP checksum code needs the split on a halfword boundary */
+	if (hdr_len & 1)
+		addr = NULL;
+
+	NetDirectRx.addr    = addr;
+	NetDirectRx.end     = end;
+	NetDirectRx.len     = len;
+	NetDirectRx.hdr_len = hdr_len;
+	NetDirectRx.port    = port;
+	NetDirectRx.match   = match & mask;
+	NetDirectRx.mask    = mask;
+}
+
+uchar *
+NetDirectRxAddr(int n)
+{
+	uchar *addr;
+
+	if (!NetDirectRx.addr)
+		return NULL;
+
+	addr = NetDirectRx.addr + n * NetDirectRx.len;
+	if (addr + NetDirectRx.len > NetDirectRx.end)
+		return NULL;
+
+	return addr;
+}
+
+void
+NetReceiveSplit(volatile uchar *hdr, int hdr_len, uchar *data, int data_len)
+{
+	Ethernet_t *et = (Ethernet_t *)hdr;
+	IP_t *ip = (IP_t *)(hdr + ETHER_HDR_SIZE);
+
+	/*
+	 * Only a plain UDP data frame for the announced stream may be
+	 * handled in place; the protocol handler finds its payload in
+	 * NetRxData.
+	 */
+	if (NetDirectRx.addr && hdr_len == NetDirectRx.hdr_len &&
+	    data_len <= NetDirectRx.len &&
+	    ntohs(et->et_protlen) == PROT_IP &&
+	    (ip->ip_hl_v & 0xff) == 0x45 &&
+	    ip->ip_p == IPPROTO_UDP &&
+	    !(ntohs(ip->ip_off) & (IP_OFFS | IP_FLAGS_MFRAG)) &&
+	    ntohs(ip->udp_dst) == NetDirectRx.port &&
+	    (ntohl(NetReadLong((ulong *)((uchar *)ip + IP_HDR_SIZE))) &
+	     NetDirectRx.mask) == NetDirectRx.match) {
+		NetRxData = data;
+		NetReceive(hdr, hdr_len + data_len);
+		NetRxData = NULL;
+		return;
+	}
+
+	/* Anything else gets glued together again */
+	if (hdr_len + data_len > PKTSIZE_ALIGN)
+		return;
+
+	memcpy(NetRxSplitBuf, (uchar *)hdr, hdr_len);
+	memcpy(NetRxSplitBuf + hdr_len, data, data_len);
+	NetReceive(NetRxSplitBuf, hdr_len + data_len);
+}
+#endif
+
 
 /**********************************************************************/
 
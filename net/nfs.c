@@ -35,11 +35,32 @@
 
 static int fs_mounted = 0;
 static unsigned long rpc_id = 0;
-static int nfs_offset = -1;
-static int nfs_len;
+static ulong nfs_filesize;	/* file size from the lookup reply */
+static int nfs_version;		/* NFS protocol version in use */
+static int nfs_rsize;		/* bytes per READ request */
 
-static char dirfh[NFS_FHSIZE];	/* file handle of directory */
-static char filefh[NFS_FHSIZE]; /* file handle of kernel image */
+static char dirfh[NFS3_FHSIZE];	/* file handle of directory */
+static int dirfh_len;
+static char filefh[NFS3_FHSIZE]; /* file handle of kernel image */
+static int filefh_len;
+
+/*
+ * Up to nfs_window READ requests are in flight at any time, each one
+ * identified by the XID of its RPC.  Replies may come back in any
+ * order and are stored at the offset of their request.
+ */
+struct nfs_read_slot {
+	unsigned long	xid;
+	ulong		offset;
+	int		len;		/* 0 if the slot is free */
+};
+static struct nfs_read_slot nfs_slots[NFS_READ_WINDOW_MAX];
+static int nfs_window;
+static ulong nfs_next;		/* offset of the next new request */
+static ulong nfs_limit;		/* no new request beyond this offset */
+static ulong nfs_eof;		/* end of file once known, else ~0 */
+static ulong nfs_rcvd;		/* bytes received, for the hashes */
+static ulong nfs_hash;		/* nfs_rcvd at the next hash */
 
 static int	NfsDownloadState;
 static IPaddr_t NfsServerIP;
@@ -85,7 +106,9 @@ store_block (uchar * src, unsigned offset, unsigned len)
 	} else
 #endif /* CONFIG_SYS_DIRECT_FLASH_NFS */
 	{
-		(void)memcpy ((void *)(load_addr + offset), src, len);
+		/* a directly received block may already be in place */
+		if ((uchar *)(load_addr + offset) != src)
+			(void)memmove ((void *)(load_addr + offset), src, len);
 	}
 
 	if (NetBootFileXferSize < (offset+len))
@@ -165,9 +188,9 @@ static long *rpc_add_credentials (long *p)
 }
 
 /**************************************************************************
-RPC_LOOKUP - Lookup RPC Port numbers
+RPC_REQ - Send an RPC call, returns its XID
 **************************************************************************/
-static void
+static unsigned long
 rpc_req (int rpc_prog, int rpc_proc, uint32_t *data, int datalen)
 {
 	struct rpc_t pkt;
@@ -175,13 +198,21 @@ rpc_req (int rpc_prog, int rpc_proc, uint32_t *data, int datalen)
 	uint32_t *p;
 	int pktlen;
 	int sport;
+	int vers;
+
+	if (rpc_prog == PROG_PORTMAP)
+		vers = 2;	/* portmapper is version 2 */
+	else if (rpc_prog == PROG_MOUNT)
+		vers = (nfs_version == 3) ? 3 : 2;
+	else
+		vers = nfs_version;
 
 	id = ++rpc_id;
 	pkt.u.call.id = htonl(id);
 	pkt.u.call.type = htonl(MSG_CALL);
 	pkt.u.call.rpcvers = htonl(2);	/* use RPC version 2 */
 	pkt.u.call.prog = htonl(rpc_prog);
-	pkt.u.call.vers = htonl(2);	/* portmapper is version 2 */
+	pkt.u.call.vers = htonl(vers);
 	pkt.u.call.proc = htonl(rpc_proc);
 	p = (uint32_t *)&(pkt.u.call.data);
 
@@ -200,6 +231,40 @@ rpc_req (int rpc_prog, int rpc_proc, uint32_t *data, int datalen)
 		sport = NfsSrvNfsPort;
 
 	NetSendUDPPacket (NetServerEther, NfsServerIP, sport, NfsOurPort, pktlen);
+
+	return id;
+}
+
+/*
+ * File handles are fixed size opaque data in NFSv2 and variable
+ * length opaque data (length word first) in NFSv3.
+ */
+static uint32_t *
+nfs_add_fh (uint32_t *p, char *fh, int fhlen)
+{
+	if (nfs_version == 3)
+		*p++ = htonl(fhlen);
+	if (fhlen & 3)
+		*(p + fhlen / 4) = 0;
+	memcpy (p, fh, fhlen);
+	return p + (fhlen + 3) / 4;
+}
+
+/* Returns the number of words used by the handle, or -1 if too long */
+static int
+nfs_get_fh (uint32_t *p, char *fh, int *fhlen)
+{
+	if (nfs_version != 3) {
+		memcpy (fh, p, NFS_FHSIZE);
+		*fhlen = NFS_FHSIZE;
+		return NFS_FHSIZE / 4;
+	}
+
+	*fhlen = ntohl(p[0]);
+	if (*fhlen > NFS3_FHSIZE)
+		return -1;
+	memcpy (fh, p + 1, *fhlen);
+	return 1 + (*fhlen + 3) / 4;
 }
 
 /**************************************************************************
@@ -286,8 +351,7 @@ nfs_readlink_req (void)
 	p = &(data[0]);
 	p = (uint32_t *)rpc_add_credentials ((long *)p);
 
-	memcpy (p, filefh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
+	p = nfs_add_fh (p, filefh, filefh_len);
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
@@ -310,8 +374,7 @@ nfs_lookup_req (char *fname)
 	p = &(data[0]);
 	p = (uint32_t *)rpc_add_credentials ((long *)p);
 
-	memcpy (p, dirfh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
+	p = nfs_add_fh (p, dirfh, dirfh_len);
 	*p++ = htonl(fnamelen);
 	if (fnamelen & 3) *(p + fnamelen / 4) = 0;
 	memcpy (p, fname, fnamelen);
@@ -319,14 +382,15 @@ nfs_lookup_req (char *fname)
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req (PROG_NFS, NFS_LOOKUP, data, len);
+	rpc_req (PROG_NFS, (nfs_version == 3) ? NFS3_LOOKUP : NFS_LOOKUP,
+		 data, len);
 }
 
 /**************************************************************************
 NFS_READ - Read File on NFS Server
 **************************************************************************/
-static void
-nfs_read_req (int offset, int readlen)
+static unsigned long
+nfs_read_req (ulong offset, int readlen)
 {
 	uint32_t data[1024];
 	uint32_t *p;
@@ -335,15 +399,122 @@ nfs_read_req (int offset, int readlen)
 	p = &(data[0]);
 	p = (uint32_t *)rpc_add_credentials ((long *)p);
 
-	memcpy (p, filefh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
+	p = nfs_add_fh (p, filefh, filefh_len);
+	if (nfs_version == 3)
+		*p++ = 0;		/* offset is 64 bit */
 	*p++ = htonl(offset);
 	*p++ = htonl(readlen);
-	*p++ = 0;
+	if (nfs_version != 3)
+		*p++ = 0;		/* totalcount, unused */
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req (PROG_NFS, NFS_READ, data, len);
+	return rpc_req (PROG_NFS, NFS_READ, data, len);
+}
+
+/**************************************************************************
+NFS read window
+**************************************************************************/
+
+#if defined(CONFIG_NET_DIRECT_RX) && !defined(CONFIG_SYS_DIRECT_FLASH_NFS)
+/*
+ * Tell the network driver where the data of the next read reply
+ * belongs, so it can be received there without a copy.  Only the
+ * reply to this very READ, recognized by its XID, may take that path.
+ */
+static void
+nfs_direct_rx (ulong offset, unsigned long xid)
+{
+	NetSetDirectRx((uchar *)(load_addr + offset),
+		       (uchar *)(load_addr + nfs_filesize), NFS_READ_SIZE,
+		       ETHER_HDR_SIZE + IP_HDR_SIZE + NFS_READ_HDR_SIZE,
+		       NfsOurPort, xid, 0xffffffff);
+}
+#else
+static inline void nfs_direct_rx (ulong offset, unsigned long xid) { }
+#endif
+
+static void
+nfs_read_send (struct nfs_read_slot *s)
+{
+	s->xid = nfs_read_req (s->offset, s->len);
+	/* only a single in-order stream can be predicted */
+	if (nfs_window == 1 && nfs_version == 2)
+		nfs_direct_rx (s->offset, s->xid);
+}
+
+/* Send new requests until the window is full or the end is reached */
+static void
+nfs_read_fill (void)
+{
+	int i;
+
+	for (i = 0; i < nfs_window; i++) {
+		if (nfs_eof != ~0UL || nfs_next > nfs_limit)
+			break;
+		if (nfs_slots[i].len)
+			continue;
+		nfs_slots[i].offset = nfs_next;
+		nfs_slots[i].len = nfs_rsize;
+		nfs_next += nfs_rsize;
+		nfs_read_send (&nfs_slots[i]);
+	}
+}
+
+static void
+nfs_read_start (void)
+{
+	memset (nfs_slots, 0, sizeof(nfs_slots));
+	nfs_next = 0;
+	/*
+	 * Don't run ahead beyond the size from the lookup; a request
+	 * at that offset still asks the server for the end of file.
+	 */
+	nfs_limit = nfs_filesize;
+	nfs_eof = ~0UL;
+	nfs_rcvd = 0;
+	nfs_hash = 0;
+
+	nfs_read_fill ();
+}
+
+static struct nfs_read_slot *
+nfs_read_slot (unsigned long xid)
+{
+	int i;
+
+	for (i = 0; i < nfs_window; i++)
+		if (nfs_slots[i].len && nfs_slots[i].xid == xid)
+			return &nfs_slots[i];
+	return NULL;
+}
+
+static void
+nfs_read_eof (ulong end)
+{
+	int i;
+
+	if (end >= nfs_eof)
+		return;
+	nfs_eof = end;
+
+	/* forget the requests beyond the end of the file */
+	for (i = 0; i < nfs_window; i++)
+		if (nfs_slots[i].offset >= end)
+			nfs_slots[i].len = 0;
+}
+
+static int
+nfs_read_done (void)
+{
+	int i;
+
+	if (nfs_eof == ~0UL)
+		return 0;
+	for (i = 0; i < nfs_window; i++)
+		if (nfs_slots[i].len)
+			return 0;
+	return 1;
 }
 
 /**************************************************************************
@@ -353,14 +524,16 @@ RPC request dispatcher
 static void
 NfsSend (void)
 {
+	int i;
+
 	debug("%s\n", __func__);
 
 	switch (NfsState) {
 	case STATE_PRCLOOKUP_PROG_MOUNT_REQ:
-		rpc_lookup_req (PROG_MOUNT, 1);
+		rpc_lookup_req (PROG_MOUNT, (nfs_version == 3) ? 3 : 1);
 		break;
 	case STATE_PRCLOOKUP_PROG_NFS_REQ:
-		rpc_lookup_req (PROG_NFS, 2);
+		rpc_lookup_req (PROG_NFS, nfs_version);
 		break;
 	case STATE_MOUNT_REQ:
 		nfs_mount_req (nfs_path);
@@ -372,7 +545,10 @@ NfsSend (void)
 		nfs_lookup_req (nfs_filename);
 		break;
 	case STATE_READ_REQ:
-		nfs_read_req (nfs_offset, nfs_len);
+		/* retransmit all outstanding reads */
+		for (i = 0; i < nfs_window; i++)
+			if (nfs_slots[i].len)
+				nfs_read_send (&nfs_slots[i]);
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req ();
@@ -433,8 +609,9 @@ nfs_mount_reply (uchar *pkt, unsigned len)
 		return -1;
 	}
 
+	if (nfs_get_fh (rpc_pkt.u.reply.data + 1, dirfh, &dirfh_len) < 0)
+		return -1;
 	fs_mounted = 1;
-	memcpy (dirfh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
 
 	return 0;
 }
@@ -467,6 +644,8 @@ static int
 nfs_lookup_reply (uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
+	uint32_t *p;
+	int n;
 
 	debug("%s\n", __func__);
 
@@ -482,7 +661,23 @@ nfs_lookup_reply (uchar *pkt, unsigned len)
 		return -1;
 	}
 
-	memcpy (filefh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	n = nfs_get_fh (rpc_pkt.u.reply.data + 1, filefh, &filefh_len);
+	if (n < 0)
+		return -1;
+
+	/* the file attributes follow the file handle */
+	p = rpc_pkt.u.reply.data + 1 + n;
+	if (nfs_version != 3) {
+		nfs_filesize = ntohl(p[5]);
+	} else if (ntohl(p[0])) {
+		if (p[6]) {
+			puts ("*** ERROR: File too large\n");
+			return -1;
+		}
+		nfs_filesize = ntohl(p[7]);
+	} else {
+		nfs_filesize = ~0UL;	/* unknown */
+	}
 
 	return 0;
 }
@@ -491,6 +686,7 @@ static int
 nfs_readlink_reply (uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
+	uint32_t *p;
 	int rlen;
 
 	debug("%s\n", __func__);
@@ -507,33 +703,53 @@ nfs_readlink_reply (uchar *pkt, unsigned len)
 		return -1;
 	}
 
-	rlen = ntohl (rpc_pkt.u.reply.data[1]); /* new path length */
+	p = rpc_pkt.u.reply.data + 1;
+	if (nfs_version == 3)	/* skip the symlink attributes */
+		p += ntohl(p[0]) ? 22 : 1;
+
+	rlen = ntohl (p[0]); /* new path length */
 
-	if (*((char *)&(rpc_pkt.u.reply.data[2])) != '/') {
+	if (*((char *)&(p[1])) != '/') {
 		int pathlen;
 		strcat (nfs_path, "/");
 		pathlen = strlen(nfs_path);
-		memcpy (nfs_path+pathlen, (uchar *)&(rpc_pkt.u.reply.data[2]), rlen);
+		memcpy (nfs_path+pathlen, (uchar *)&(p[1]), rlen);
 		nfs_path[pathlen + rlen] = 0;
 	} else {
-		memcpy (nfs_path, (uchar *)&(rpc_pkt.u.reply.data[2]), rlen);
+		memcpy (nfs_path, (uchar *)&(p[1]), rlen);
 		nfs_path[rlen] = 0;
 	}
 	return 0;
 }
 
+/*
+ * Returns 0 if the reply was handled, 1 if it does not belong to an
+ * outstanding read, and a negative value on errors.
+ */
 static int
 nfs_read_reply (uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
-	int rlen;
+	struct nfs_read_slot *s;
+	uint32_t *data;
+	uchar *src;
+	ulong offset;
+	unsigned hdrlen;
+	int rlen, eof, i;
 
 	debug("%s\n", __func__);
 
-	memcpy ((uchar *)&rpc_pkt, pkt, sizeof(rpc_pkt.u.reply));
+	/* A short (error) reply must not be read past its end */
+	hdrlen = (nfs_version == 3) ? NFS3_READ_HDR_SIZE : NFS_READ_HDR_SIZE;
+	if (len < hdrlen) {
+		memset ((uchar *)&rpc_pkt + len, 0, hdrlen - len);
+		hdrlen = len;
+	}
+	memcpy ((uchar *)&rpc_pkt, pkt, hdrlen);
 
-	if (ntohl(rpc_pkt.u.reply.id) != rpc_id)
-		return -1;
+	s = nfs_read_slot (ntohl(rpc_pkt.u.reply.id));
+	if (s == NULL)
+		return 1;
 
 	if (rpc_pkt.u.reply.rstatus  ||
 	    rpc_pkt.u.reply.verifier ||
@@ -548,18 +764,55 @@ nfs_read_reply (uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);;
 	}
 
-	if ((nfs_offset!=0) && !((nfs_offset) % (NFS_READ_SIZE/2*10*HASHES_PER_LINE))) {
-		puts ("\n\t ");
+	data = rpc_pkt.u.reply.data;
+	if (nfs_version == 3) {
+		i = ntohl(data[1]) ? 23 : 2;	/* skip the file attributes */
+		rlen = ntohl(data[i]);
+		eof = ntohl(data[i + 1]);
+		i += 3;
+	} else {
+		rlen = ntohl(data[18]);
+		eof = 0;
+		i = 19;
 	}
-	if (!(nfs_offset % ((NFS_READ_SIZE/2)*10))) {
+	if (rlen > s->len)
+		return -9999;
+	if ((uchar *)&data[i] - (uchar *)&rpc_pkt + rlen > len)
+		return -9999;
+
+	while (nfs_hash <= nfs_rcvd) {
+		if (nfs_hash && !(nfs_hash % (NFS_READ_SIZE/2*10*HASHES_PER_LINE)))
+			puts ("\n\t ");
 		putc ('#');
+		nfs_hash += NFS_READ_SIZE/2*10;
 	}
 
-	rlen = ntohl(rpc_pkt.u.reply.data[18]);
-	if ( store_block ((uchar *)pkt+sizeof(rpc_pkt.u.reply), nfs_offset, rlen) )
+	src = pkt + ((uchar *)&data[i] - (uchar *)&rpc_pkt);
+#ifdef CONFIG_NET_DIRECT_RX
+	if (NetRxData)
+		src = NetRxData;
+#endif
+	if (store_block (src, s->offset, rlen))
 		return -9999;
+	nfs_rcvd += rlen;
+
+	offset = s->offset + rlen;
+	if (eof || rlen == 0) {
+		s->len = 0;
+		nfs_read_eof (offset);
+	} else if (rlen < s->len) {
+		/* short read: ask for the rest */
+		s->offset = offset;
+		s->len -= rlen;
+		nfs_read_send (s);
+	} else {
+		s->len = 0;
+		/* the file has grown since the lookup */
+		if (offset > nfs_limit)
+			nfs_limit = ~0UL;
+	}
 
-	return rlen;
+	return 0;
 }
 
 /**************************************************************************
@@ -582,12 +835,18 @@ NfsTimeout (void)
 static void
 NfsHandler (uchar *pkt, unsigned dest, unsigned src, unsigned len)
 {
+	uint32_t id;
 	int rlen;
 
 	debug("%s\n", __func__);
 
 	if (dest != NfsOurPort) return;
 
+	/* drop late replies to requests we no longer wait for */
+	memcpy (&id, pkt, sizeof(id));
+	if (NfsState != STATE_READ_REQ && ntohl(id) != rpc_id)
+		return;
+
 	switch (NfsState) {
 	case STATE_PRCLOOKUP_PROG_MOUNT_REQ:
 		rpc_lookup_reply (PROG_MOUNT, pkt, len);
@@ -596,8 +855,17 @@ NfsHandler (uchar *pkt, unsigned dest, unsigned src, unsigned len)
 		break;
 
 	case STATE_PRCLOOKUP_PROG_NFS_REQ:
-		rpc_lookup_reply (PROG_NFS, pkt, len);
-		NfsState = STATE_MOUNT_REQ;
+		if (rpc_lookup_reply (PROG_NFS, pkt, len) == 0 &&
+		    (NfsSrvMountPort == 0 || NfsSrvNfsPort == 0) &&
+		    nfs_version == 3) {
+			/* the server doesn't register v3: fall back to v2 */
+			debug("NFSv3 not available, using NFSv2\n");
+			nfs_version = 2;
+			nfs_rsize = min(NFS_READ_SIZE, NFS_MAXDATA);
+			NfsState = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
+		} else {
+			NfsState = STATE_MOUNT_REQ;
+		}
 		NfsSend ();
 		break;
 
@@ -630,9 +898,7 @@ NfsHandler (uchar *pkt, unsigned dest, unsigned src, unsigned len)
 			NfsSend ();
 		} else {
 			NfsState = STATE_READ_REQ;
-			nfs_offset = 0;
-			nfs_len = NFS_READ_SIZE;
-			NfsSend ();
+			nfs_read_start ();
 		}
 		break;
 
@@ -653,9 +919,16 @@ NfsHandler (uchar *pkt, unsigned dest, unsigned src, unsigned len)
 
 	case STATE_READ_REQ:
 		rlen = nfs_read_reply (pkt, len);
+		if (rlen > 0)		/* not for one of our reads */
+			break;
 		NetSetTimeout (NFS_TIMEOUT, NfsTimeout);
-		if (rlen > 0) {
-			nfs_offset += rlen;
+		if (rlen == 0) {
+			if (!nfs_read_done ()) {
+				nfs_read_fill ();
+				break;
+			}
+			NfsDownloadState = NETLOOP_SUCCESS;
+			NfsState = STATE_UMOUNT_REQ;
 			NfsSend ();
 		}
 		else if ((rlen == -NFSERR_ISDIR)||(rlen == -NFSERR_INVAL)) {
@@ -663,7 +936,6 @@ NfsHandler (uchar *pkt, unsigned dest, unsigned src, unsigned len)
 			NfsState = STATE_READLINK_REQ;
 			NfsSend ();
 		} else {
-			if ( ! rlen ) NfsDownloadState = NETLOOP_SUCCESS;
 			NfsState = STATE_UMOUNT_REQ;
 			NfsSend ();
 		}
@@ -675,6 +947,8 @@ NfsHandler (uchar *pkt, unsigned dest, unsigned src, unsigned len)
 void
 NfsStart (void)
 {
+	char *ep;
+
 	debug("%s\n", __func__);
 	NfsDownloadState = NETLOOP_FAIL;
 
@@ -744,6 +1018,22 @@ NfsStart (void)
 	NfsTimeoutCount = 0;
 	NfsState = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
 
+#ifdef CONFIG_NFS_V3
+	nfs_version = 3;
+	nfs_rsize = NFS_READ_SIZE;
+#else
+	nfs_version = 2;
+	nfs_rsize = min(NFS_READ_SIZE, NFS_MAXDATA);
+#endif
+
+	nfs_window = CONFIG_NFS_READ_WINDOW;
+	if ((ep = getenv("nfswindowsize")) != NULL)
+		nfs_window = simple_strtol(ep, NULL, 10);
+	if (nfs_window < 1)
+		nfs_window = 1;
+	if (nfs_window > NFS_READ_WINDOW_MAX)
+		nfs_window = NFS_READ_WINDOW_MAX;
+
 	/*NfsOurPort = 4096 + (get_ticks() % 3072);*/
 	/*FIX ME !!!*/
 	NfsOurPort = 1000;
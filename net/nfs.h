@@ -28,7 +28,12 @@
 #define NFS_READLINK    5
 #define NFS_READ        6
 
+#define NFS3_LOOKUP     3	/* 4 is ACCESS in NFSv3 */
+
 #define NFS_FHSIZE      32
+#define NFS3_FHSIZE     64
+
+#define NFS_MAXDATA     8192	/* largest NFSv2 READ */
 
 #define NFSERR_PERM     1
 #define NFSERR_NOENT    2
@@ -49,6 +54,12 @@
 
 #define NFS_MAXLINKDEPTH 16
 
+/* Number of READ requests kept in flight, see README */
+#ifndef CONFIG_NFS_READ_WINDOW
+#define CONFIG_NFS_READ_WINDOW	1
+#endif
+#define NFS_READ_WINDOW_MAX	32
+
 struct rpc_t {
 	union {
 		uint8_t data[2048];
@@ -72,6 +83,11 @@ struct rpc_t {
 		} reply;
 	} u;
 };
+
+/* Bytes in front of the data of a READ reply (with attributes for v3) */
+#define NFS_READ_HDR_SIZE	(sizeof(((struct rpc_t *)0)->u.reply))
+#define NFS3_READ_HDR_SIZE	(NFS_READ_HDR_SIZE + 7 * sizeof(uint32_t))
+
 extern void	NfsStart (void);	/* Begin NFS */
 
 
@@ -93,6 +93,21 @@ static char tftp_filename[MAX_LEN];
 extern flash_info_t flash_info[];
 #endif
 
+/*
+ * Direct receive needs to know where the file ends, so the driver is
+ * never told to put a block beyond it, and can't be used for flash.
+ */
+#if defined(CONFIG_NET_DIRECT_RX) && defined(CONFIG_TFTP_TSIZE) && \
+	!defined(CONFIG_SYS_DIRECT_FLASH_TFTP)
+#define TFTP_DIRECT_RX
+#endif
+
+/* uncompress images while they are received ("tftpunpack" = "yes") */
+#if defined(CONFIG_IMAGE_STREAM) && !defined(CONFIG_SYS_DIRECT_FLASH_TFTP)
+#define TFTP_UNPACK
+static int	TftpUnpack;
+#endif
+
 /* 512 is poor choice for ethernet, MTU is typically 1500.
  * Minus eth.hdrs thats 1468.  Can get 2x better throughput with
  * almost-MTU block sizes.  At least try... fall back to 512 if need be.
@@ -102,6 +117,20 @@ extern flash_info_t flash_info[];
 static unsigned short TftpBlkSize=TFTP_BLOCK_SIZE;
 static unsigned short TftpBlkSizeOption=TFTP_MTU_BLOCKSIZE;
 
+/*
+ * RFC 7440 sliding window: the server sends up to TftpWindowSize
+ * blocks before waiting for an ACK, so we only acknowledge at window
+ * boundaries (TftpNextAck).  A window size of 1 is plain RFC 1350
+ * lock-step and the option is not even sent to the server then.
+ */
+#ifndef CONFIG_TFTP_WINDOWSIZE
+#define CONFIG_TFTP_WINDOWSIZE	1
+#endif
+static unsigned short TftpWindowSize = 1;
+static unsigned short TftpWindowSizeOption = CONFIG_TFTP_WINDOWSIZE;
+static ulong	TftpNextAck;		/* block that completes the window	*/
+static ulong	TftpLastNack;		/* last block re-ACKed after a loss	*/
+
 #ifdef CONFIG_MCAST_TFTP
 #include <malloc.h>
 #define MTFTP_BITMAPSIZE	0x1000
@@ -134,6 +163,26 @@ store_block (unsigned block, uchar * src, unsigned len)
 	ulong newsize = offset + len;
 #ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
 	int i, rc = 0;
+#endif
+
+#ifdef TFTP_UNPACK
+	if (TftpUnpack) {
+		int rc = image_stream_write(src, len);
+
+		if (rc < 0) {
+			puts ("\nTFTP error: cannot unpack image\n");
+			NetState = NETLOOP_FAIL;
+			return;
+		}
+		if (rc == 0) {
+			/* taken over by the unpacker */
+			if (NetBootFileXferSize < newsize)
+				NetBootFileXferSize = newsize;
+			return;
+		}
+	}
+#endif
+#ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
 
 	for (i=0; i<CONFIG_SYS_MAX_FLASH_BANKS; i++) {
 		/* start address in flash? */
@@ -156,7 +205,9 @@ store_block (unsigned block, uchar * src, unsigned len)
 	else
 #endif /* CONFIG_SYS_DIRECT_FLASH_TFTP */
 	{
-		(void)memcpy((void *)(load_addr + offset), src, len);
+		/* a directly received block may already be in place */
+		if ((uchar *)(load_addr + offset) != src)
+			(void)memmove((void *)(load_addr + offset), src, len);
 	}
 #ifdef CONFIG_MCAST_TFTP
 	if (Multicast)
@@ -167,6 +218,35 @@ store_block (unsigned block, uchar * src, unsigned len)
 		NetBootFileXferSize = newsize;
 }
 
+#ifdef TFTP_DIRECT_RX
+/*
+ * Tell the network driver where the payload of the block following
+ * "block" belongs, so it can be received there without a copy.
+ */
+static void
+TftpDirectRx (ulong block)
+{
+	uchar *addr = (uchar *)(load_addr + block * TftpBlkSize +
+				TftpBlockWrapOffset);
+
+#ifdef CONFIG_MCAST_TFTP
+	if (Multicast)
+		return;
+#endif
+#ifdef TFTP_UNPACK
+	/* the unpacker writes where the blocks would be received */
+	if (TftpUnpack)
+		return;
+#endif
+	if (TftpTsize == 0)
+		return;
+
+	NetSetDirectRx(addr, (uchar *)(load_addr + TftpTsize), TftpBlkSize,
+		       ETHER_HDR_SIZE + IP_HDR_SIZE + 4, TftpOurPort,
+		       TFTP_DATA << 16, 0xffff0000);
+}
+#endif
+
 static void TftpSend (void);
 static void TftpTimeout (void);
 
@@ -216,6 +296,10 @@ TftpSend (void)
 		/* try for more effic. blk size */
 		pkt += sprintf((char *)pkt,"blksize%c%d%c",
 				0,TftpBlkSizeOption,0);
+		/* ask for a sliding window if one is configured */
+		if (TftpWindowSizeOption > 1)
+			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
+					0, TftpWindowSizeOption, 0);
 #ifdef CONFIG_MCAST_TFTP
 		/* Check all preconditions before even trying the option */
 		if (!ProhibitMcast
@@ -325,6 +409,15 @@ TftpHandler (uchar * pkt, unsigned dest, unsigned src, unsigned len)
 				debug("Blocksize ack: %s, %d\n",
 					(char*)pkt+i+8,TftpBlkSize);
 			}
+			if (strcmp((char *)pkt + i, "windowsize") == 0) {
+				TftpWindowSize = (unsigned short)
+					simple_strtoul((char *)pkt + i + 11,
+						       NULL, 10);
+				if (TftpWindowSize == 0)
+					TftpWindowSize = 1;
+				debug("Windowsize ack: %s, %d\n",
+					(char *)pkt + i + 11, TftpWindowSize);
+			}
 #ifdef CONFIG_TFTP_TSIZE
 			if (strcmp ((char*)pkt+i,"tsize") == 0) {
 				TftpTsize = simple_strtoul((char*)pkt+i+6,NULL,10);
@@ -333,8 +426,16 @@ TftpHandler (uchar * pkt, unsigned dest, unsigned src, unsigned len)
 			}
 #endif
 		}
+		/* the ACK below for block 0 opens the first window */
+		TftpNextAck = TftpWindowSize;
+		TftpLastNack = TFTP_SEQUENCE_SIZE;
+#ifdef TFTP_DIRECT_RX
+		TftpDirectRx(0);
+#endif
 #ifdef CONFIG_MCAST_TFTP
 		parse_multicast_oack((char *)pkt,len-1);
+		if (Multicast)
+			TftpWindowSize = 1;
 		if ((Multicast) && (!MasterClient))
 			TftpState = STATE_DATA;	/* passive.. */
 		else
@@ -347,33 +448,6 @@ TftpHandler (uchar * pkt, unsigned dest, unsigned src, unsigned len)
 		len -= 2;
 		TftpBlock = ntohs(*(ushort *)pkt);
 
-		/*
-		 * RFC1350 specifies that the first data packet will
-		 * have sequence number 1. If we receive a sequence
-		 * number of 0 this means that there was a wrap
-		 * around of the (16 bit) counter.
-		 */
-		if (TftpBlock == 0) {
-			TftpBlockWrap++;
-			TftpBlockWrapOffset += TftpBlkSize * TFTP_SEQUENCE_SIZE;
-			printf ("\n\t %lu MB received\n\t ", TftpBlockWrapOffset>>20);
-		}
-#ifdef CONFIG_TFTP_TSIZE
-		else if (TftpTsize) {
-			while (TftpNumchars < NetBootFileXferSize * 50 / TftpTsize) {
-				putc('#');
-				TftpNumchars++;
-			}
-		}
-#endif
-		else {
-			if (((TftpBlock - 1) % 10) == 0) {
-				putc ('#');
-			} else if ((TftpBlock % (10 * HASHES_PER_LINE)) == 0) {
-				puts ("\n\t ");
-			}
-		}
-
 		if (TftpState == STATE_RRQ)
 			debug("Server did not acknowledge timeout option!\n");
 
@@ -407,11 +481,70 @@ TftpHandler (uchar * pkt, unsigned dest, unsigned src, unsigned len)
 			break;
 		}
 
+		if (TftpWindowSize > 1 &&
+		    TftpBlock != (TftpLastBlock + 1) % TFTP_SEQUENCE_SIZE) {
+			/*
+			 * A block of the current window went missing or
+			 * arrived out of order.  Drop everything after the
+			 * hole and ACK the last block we stored in sequence,
+			 * so the server rewinds and resends the window from
+			 * there.  Only do that once per hole, the rest of
+			 * the window is still in flight and would otherwise
+			 * trigger a storm of duplicate ACKs.
+			 */
+			debug("Unexpected block %ld, expected %ld\n",
+				TftpBlock, (TftpLastBlock + 1) %
+				TFTP_SEQUENCE_SIZE);
+			TftpBlock = TftpLastBlock;
+			if (TftpLastNack != TftpBlock) {
+				TftpLastNack = TftpBlock;
+				TftpNextAck = (TftpBlock + TftpWindowSize) %
+					TFTP_SEQUENCE_SIZE;
+				TftpSend ();
+			}
+			break;
+		}
+
+		/*
+		 * RFC1350 specifies that the first data packet will
+		 * have sequence number 1. If we receive a sequence
+		 * number of 0 this means that there was a wrap
+		 * around of the (16 bit) counter.
+		 */
+		if (TftpBlock == 0) {
+			TftpBlockWrap++;
+			TftpBlockWrapOffset += TftpBlkSize * TFTP_SEQUENCE_SIZE;
+			printf ("\n\t %lu MB received\n\t ", TftpBlockWrapOffset>>20);
+		}
+#ifdef CONFIG_TFTP_TSIZE
+		else if (TftpTsize) {
+			while (TftpNumchars < NetBootFileXferSize * 50 / TftpTsize) {
+				putc('#');
+				TftpNumchars++;
+			}
+		}
+#endif
+		else {
+			if (((TftpBlock - 1) % 10) == 0) {
+				putc ('#');
+			} else if ((TftpBlock % (10 * HASHES_PER_LINE)) == 0) {
+				puts ("\n\t ");
+			}
+		}
+
 		TftpLastBlock = TftpBlock;
 		TftpTimeoutCountMax = TIMEOUT_COUNT;
 		NetSetTimeout (TftpTimeoutMSecs, TftpTimeout);
 
+#ifdef CONFIG_NET_DIRECT_RX
+		if (NetRxData)
+			store_block (TftpBlock - 1, NetRxData, len);
+		else
+#endif
 		store_block (TftpBlock - 1, pkt + 2, len);
+#ifdef TFTP_DIRECT_RX
+		TftpDirectRx(TftpBlock);
+#endif
 
 		/*
 		 *	Acknoledge the block just received, which will prompt
@@ -442,7 +575,16 @@ TftpHandler (uchar * pkt, unsigned dest, unsigned src, unsigned len)
 			}
 		}
 #endif
-		TftpSend ();
+		/*
+		 * With a sliding window only the block closing the window
+		 * (or the short final block) gets acknowledged.
+		 */
+		if (TftpWindowSize == 1 || len < TftpBlkSize ||
+		    TftpBlock == TftpNextAck) {
+			TftpNextAck = (TftpBlock + TftpWindowSize) %
+				TFTP_SEQUENCE_SIZE;
+			TftpSend ();
+		}
 
 #ifdef CONFIG_MCAST_TFTP
 		if (Multicast) {
@@ -465,6 +607,20 @@ TftpHandler (uchar * pkt, unsigned dest, unsigned src, unsigned len)
 				putc('#');
 				TftpNumchars++;
 			}
+#endif
+#ifdef TFTP_UNPACK
+			if (TftpUnpack) {
+				ulong size;
+				int rc = image_stream_finish(&size);
+
+				if (rc < 0) {
+					puts ("\nTFTP error: cannot unpack image\n");
+					NetState = NETLOOP_FAIL;
+					break;
+				}
+				if (rc == 0)	/* size of the unpacked image */
+					NetBootFileXferSize = size;
+			}
 #endif
 			puts ("\ndone\n");
 			NetState = NETLOOP_SUCCESS;
@@ -512,6 +668,10 @@ TftpTimeout (void)
 	} else {
 		puts ("T ");
 		NetSetTimeout (TftpTimeoutMSecs, TftpTimeout);
+		/* the server restarts its window after our last ACK */
+		if (TftpState == STATE_DATA)
+			TftpNextAck = (TftpBlock + TftpWindowSize) %
+				TFTP_SEQUENCE_SIZE;
 		TftpSend ();
 	}
 }
@@ -532,6 +692,22 @@ TftpStart (void)
 	if ((ep = getenv("tftptimeout")) != NULL)
 		TftpTimeoutMSecs = simple_strtol(ep, NULL, 10);
 
+	TftpWindowSizeOption = CONFIG_TFTP_WINDOWSIZE;
+	if ((ep = getenv("tftpwindowsize")) != NULL)
+		TftpWindowSizeOption = simple_strtol(ep, NULL, 10);
+
+#ifdef TFTP_UNPACK
+	ep = getenv("tftpunpack");
+	TftpUnpack = ep && strcmp(ep, "yes") == 0;
+#ifdef CONFIG_MCAST_TFTP
+	/* multicast blocks don't arrive in order */
+	if (!ProhibitMcast)
+		TftpUnpack = 0;
+#endif
+	if (TftpUnpack)
+		image_stream_start(load_addr);
+#endif
+
 	if (TftpTimeoutMSecs < 1000) {
 		printf("TFTP timeout (%ld ms) too low, "
 			"set minimum = 1000 ms\n",
@@ -622,6 +798,10 @@ TftpStart (void)
 	memset(NetServerEther, 0, 6);
 	/* Revert TftpBlkSize to dflt */
 	TftpBlkSize = TFTP_BLOCK_SIZE;
+	/* Lock-step until the server acknowledges a window */
+	TftpWindowSize = 1;
+	TftpNextAck = 0;
+	TftpLastNack = TFTP_SEQUENCE_SIZE;
 #ifdef CONFIG_MCAST_TFTP
 	mcast_cleanup();
 #endif
@@ -152,6 +152,7 @@
 
 #include <post.h>
 #include <watchdog.h>
+#include <memtest.h>
 
 #if CONFIG_POST & CONFIG_SYS_POST_MEMORY
 
@@ -172,6 +173,27 @@ DECLARE_GLOBAL_DATA_PTR;
 #warning "Injecting address line errors for testing purposes"
 #endif
 
+#ifdef CONFIG_SYS_FAST_MEMTEST
+
+static void memory_post_report (const char *test, ulong addr,
+				u64 expected, u64 actual)
+{
+	post_log ("Memory (%s) error at %08lx, "
+		  "wrote %08x%08x, read %08x%08x !\n", test, addr,
+		  (uint)(expected >> 32), (uint)expected,
+		  (uint)(actual >> 32), (uint)actual);
+}
+
+static int memory_post_tests (unsigned long start, unsigned long size)
+{
+	if (memtest_run (start, size, MEMTEST_ALL | MEMTEST_FIRST_ERROR, 0,
+			 memory_post_report))
+		return -1;
+	return 0;
+}
+
+#else /* !CONFIG_SYS_FAST_MEMTEST */
+
 
 /*
  * This function performs a double word move from the data at
@@ -452,12 +474,19 @@ static int memory_post_tests (unsigned long start, unsigned long size)
 	return ret;
 }
 
+#endif /* CONFIG_SYS_FAST_MEMTEST */
+
 int memory_post_test (int flags)
 {
 	int ret = 0;
 	bd_t *bd = gd->bd;
+#ifdef CONFIG_SYS_FAST_MEMTEST
+	/* fast enough to test all of the memory */
+	unsigned long memsize = bd->bi_memsize - (1 << 20);
+#else
 	unsigned long memsize = (bd->bi_memsize >= 256 << 20 ?
 				 256 << 20 : bd->bi_memsize) - (1 << 20);
+#endif
 
 	/* Limit area to be tested with the board info struct */
 	if (CONFIG_SYS_SDRAM_BASE + memsize > (ulong)bd)
@@ -0,0 +1,262 @@
+/*
+ * (C) Copyright 2010
+ * The U-Boot Authors
+ *
+ * Host test for the BCH library in lib/bch.c: injects random bit errors
+ * into encoded blocks, checks that up to t errors are corrected and that
+ * more than t errors are reported as uncorrectable, and times encoding
+ * and decoding of a 2 KiB page.
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <linux/bch.h>
+
+#define PAGE_SIZE	2048
+#define MAX_ECC_BYTES	64
+#define MAX_ERRORS	64
+#define TIMING_LOOPS	2000
+
+/* Geometries in use with NAND: m, t and the ECC block size in bytes */
+static const struct {
+	int m;
+	int t;
+	unsigned int len;
+} configs[] = {
+	{ 13,  4,  512 },
+	{ 13,  8,  512 },
+	{ 13, 16,  512 },
+	{ 14,  8, 1024 },
+	{ 14, 24, 1024 },
+};
+
+static unsigned int seed = 1;
+
+static unsigned int rnd(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+static double now(void)
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/*
+ * Flip nerr distinct random bits among the data and ECC bits of a block.
+ * ECC bits are counted from the MSB of the first ECC byte.
+ */
+static void inject(struct bch_control *bch, unsigned char *data,
+		   unsigned int len, unsigned char *ecc, int nerr)
+{
+	unsigned int pos[MAX_ERRORS], nbits = 8 * len + bch->ecc_bits, p;
+	int i, k;
+
+	for (i = 0; i < nerr; i++) {
+		do {
+			p = rnd() % nbits;
+			for (k = 0; k < i && pos[k] != p; k++)
+				;
+		} while (k < i);
+		pos[i] = p;
+
+		if (p < 8 * len)
+			data[p / 8] ^= 1 << (p % 8);
+		else
+			ecc[(p - 8 * len) / 8] ^= 0x80 >> ((p - 8 * len) % 8);
+	}
+}
+
+/* Correct data and ECC bits the way nand_bch_correct_data() does */
+static void correct(struct bch_control *bch, unsigned char *data,
+		    unsigned int len, unsigned char *ecc,
+		    unsigned int *errloc, int nerr)
+{
+	unsigned int q;
+	int i;
+
+	correct_bch(bch, data, len, errloc, nerr);
+	for (i = 0; i < nerr; i++) {
+		if (errloc[i] < 8 * len)
+			continue;
+		q = errloc[i] - 8 * len;
+		ecc[q / 8] ^= 1 << (q % 8);
+	}
+}
+
+static int test_config(int m, int t, unsigned int len, int iterations)
+{
+	struct bch_control *bch;
+	unsigned char *data, *orig, ecc[MAX_ECC_BYTES], recv[MAX_ECC_BYTES];
+	unsigned char calc[MAX_ECC_BYTES];
+	unsigned int errloc[MAX_ERRORS];
+	int nerr, it, ret, fails = 0, detected, miscorrected;
+	double start, enc, dec;
+
+	bch = init_bch(m, t, 0);
+	if (!bch) {
+		printf("m=%d t=%d: init_bch failed\n", m, t);
+		return 1;
+	}
+
+	data = malloc(PAGE_SIZE);
+	orig = malloc(PAGE_SIZE);
+	if (!data || !orig) {
+		free_bch(bch);
+		return 1;
+	}
+
+	printf("m=%d t=%d len=%u ecc_bytes=%u\n", m, t, len, bch->ecc_bytes);
+
+	/* 0..t errors must all be corrected */
+	for (nerr = 0; nerr <= t; nerr++) {
+		for (it = 0; it < iterations; it++) {
+			for (ret = 0; ret < len; ret++)
+				orig[ret] = data[ret] = rnd();
+			memset(ecc, 0, bch->ecc_bytes);
+			encode_bch(bch, data, len, ecc);
+			memcpy(recv, ecc, bch->ecc_bytes);
+
+			inject(bch, data, len, recv, nerr);
+
+			memset(calc, 0, bch->ecc_bytes);
+			encode_bch(bch, data, len, calc);
+			ret = decode_bch(bch, NULL, len, recv, calc, errloc);
+			if (ret != nerr) {
+				printf("  %d errors: decode returned %d\n",
+				       nerr, ret);
+				fails++;
+				break;
+			}
+			correct(bch, data, len, recv, errloc, ret);
+			if (memcmp(data, orig, len) ||
+			    memcmp(recv, ecc, bch->ecc_bytes)) {
+				printf("  %d errors: miscorrected\n", nerr);
+				fails++;
+				break;
+			}
+		}
+	}
+
+	/*
+	 * Beyond t the decoder must report -EBADMSG; it may only "correct"
+	 * a block into another valid codeword, which is rare for these codes.
+	 */
+	for (nerr = t + 1; nerr <= t + 4 && nerr <= MAX_ERRORS; nerr++) {
+		detected = miscorrected = 0;
+		for (it = 0; it < iterations; it++) {
+			for (ret = 0; ret < len; ret++)
+				orig[ret] = data[ret] = rnd();
+			memset(ecc, 0, bch->ecc_bytes);
+			encode_bch(bch, data, len, ecc);
+			memcpy(recv, ecc, bch->ecc_bytes);
+
+			inject(bch, data, len, recv, nerr);
+
+			memset(calc, 0, bch->ecc_bytes);
+			encode_bch(bch, data, len, calc);
+			ret = decode_bch(bch, NULL, len, recv, calc, errloc);
+			if (ret == -EBADMSG) {
+				detected++;
+				continue;
+			}
+			if (ret < 0 || ret > t) {
+				printf("  %d errors: decode returned %d\n",
+				       nerr, ret);
+				fails++;
+				break;
+			}
+
+			/* the result must at least be a valid codeword */
+			correct(bch, data, len, recv, errloc, ret);
+			memset(calc, 0, bch->ecc_bytes);
+			encode_bch(bch, data, len, calc);
+			if (memcmp(calc, recv, bch->ecc_bytes - 1)) {
+				printf("  %d errors: bad correction\n", nerr);
+				fails++;
+				break;
+			}
+			miscorrected++;
+		}
+		printf("  %d errors: %d/%d detected, %d miscorrected\n",
+		       nerr, detected, iterations, miscorrected);
+		if (miscorrected > 5 + iterations / 50) {
+			printf("  %d errors: too many miscorrections\n", nerr);
+			fails++;
+		}
+	}
+
+	/* encode and decode (with t errors) a whole page, block by block */
+	for (ret = 0; ret < PAGE_SIZE; ret++)
+		data[ret] = rnd();
+
+	start = now();
+	for (it = 0; it < TIMING_LOOPS; it++)
+		for (ret = 0; ret + len <= PAGE_SIZE; ret += len) {
+			memset(ecc, 0, bch->ecc_bytes);
+			encode_bch(bch, data + ret, len, ecc);
+		}
+	enc = (now() - start) / TIMING_LOOPS;
+
+	memcpy(recv, ecc, bch->ecc_bytes);
+	inject(bch, data + PAGE_SIZE - len, len, recv, t);
+	memset(calc, 0, bch->ecc_bytes);
+	encode_bch(bch, data + PAGE_SIZE - len, len, calc);
+
+	start = now();
+	for (it = 0; it < TIMING_LOOPS; it++)
+		for (ret = 0; ret + len <= PAGE_SIZE; ret += len)
+			decode_bch(bch, NULL, len, recv, calc, errloc);
+	dec = (now() - start) / TIMING_LOOPS;
+
+	printf("  %d byte page: encode %.1f us, decode %.1f us\n",
+	       PAGE_SIZE, enc * 1e6, dec * 1e6);
+
+	free(orig);
+	free(data);
+	free_bch(bch);
+	return fails;
+}
+
+int main(int argc, char **argv)
+{
+	int i, iterations = 1000, fails = 0;
+
+	if (argc > 1)
+		iterations = atoi(argv[1]);
+	if (argc > 2)
+		seed = strtoul(argv[2], NULL, 0);
+	if (iterations <= 0) {
+		fprintf(stderr, "usage: %s [iterations [seed]]\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < sizeof(configs) / sizeof(configs[0]); i++)
+		fails += test_config(configs[i].m, configs[i].t,
+				     configs[i].len, iterations);
+
+	printf(fails ? "FAIL\n" : "PASS\n");
+	return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/*
+ * (C) Copyright 2010
+ * The U-Boot Authors
+ *
+ * Host test for lib/crc32.c: compares crc32(), crc32_no_comp() and
+ * crc32_wd() with a bit-wise reference over all alignments of the
+ * buffer and all short lengths, so the byte-wise head and tail of the
+ * slice-by-8 loop are covered, and over random longer buffers.
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <u-boot/crc.h>
+
+#define BUF_SIZE	4096
+#define MAX_ALIGN	16	/* more than the 8 bytes of a slice */
+#define MAX_SHORT	80	/* all lengths up to this one */
+
+static unsigned int seed = 1;
+
+static unsigned int rnd(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+/* one bit at a time, no tables: the definition of the CRC */
+static uint32_t ref_crc32_no_comp(uint32_t crc, const unsigned char *p,
+				  unsigned int len)
+{
+	int k;
+
+	while (len--) {
+		crc ^= *p++;
+		for (k = 0; k < 8; k++)
+			crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+	}
+	return crc;
+}
+
+static uint32_t ref_crc32(uint32_t crc, const unsigned char *p,
+			  unsigned int len)
+{
+	return ref_crc32_no_comp(crc ^ 0xffffffff, p, len) ^ 0xffffffff;
+}
+
+static int check(const char *what, unsigned int len, unsigned int align,
+		 uint32_t crc, uint32_t want)
+{
+	if (crc == want)
+		return 0;
+
+	printf("%s: align %u len %u: 0x%08x, expected 0x%08x\n",
+	       what, align, len, crc, want);
+	return 1;
+}
+
+static int test_buf(const unsigned char *p, unsigned int len,
+		    unsigned int align)
+{
+	uint32_t start = rnd();
+	int fails = 0;
+
+	fails += check("crc32", len, align,
+		       crc32(0, p, len), ref_crc32(0, p, len));
+	fails += check("crc32 (continued)", len, align,
+		       crc32(start, p, len), ref_crc32(start, p, len));
+	fails += check("crc32_no_comp", len, align,
+		       crc32_no_comp(start, p, len),
+		       ref_crc32_no_comp(start, p, len));
+	fails += check("crc32_wd", len, align,
+		       crc32_wd(start, p, len, 1 + rnd() % 64),
+		       ref_crc32(start, p, len));
+	return fails;
+}
+
+int main(int argc, char **argv)
+{
+	static unsigned char buf[BUF_SIZE + MAX_ALIGN];
+	unsigned int align, len;
+	int it, iterations = 1000, fails = 0;
+
+	if (argc > 1)
+		iterations = atoi(argv[1]);
+	if (argc > 2)
+		seed = strtoul(argv[2], NULL, 0);
+	if (iterations <= 0) {
+		fprintf(stderr, "usage: %s [iterations [seed]]\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	for (len = 0; len < sizeof(buf); len++)
+		buf[len] = rnd();
+
+	/* the check value of the CRC-32 catalogue */
+	fails += check("crc32", 9, 0,
+		       crc32(0, (unsigned char *)"123456789", 9), 0xcbf43926);
+
+	/* every head and tail the word loop can leave */
+	for (align = 0; align < MAX_ALIGN; align++)
+		for (len = 0; len <= MAX_SHORT; len++)
+			fails += test_buf(buf + align, len, align);
+
+	/* longer and odd sized buffers */
+	for (it = 0; it < iterations; it++) {
+		align = rnd() % MAX_ALIGN;
+		len = rnd() % (BUF_SIZE + 1);
+		fails += test_buf(buf + align, len, align);
+	}
+
+	printf(fails ? "FAIL\n" : "PASS\n");
+	return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,213 @@
+/*
+ * (C) Copyright 2010
+ * The U-Boot Authors
+ *
+ * Host test for the word-at-a-time memset(), memcpy() and memmove()
+ * and for strlen() in lib/string.c: compares them with byte-wise
+ * references for every combination of source and destination
+ * alignment and all short lengths, so each head and tail the word
+ * loops can leave is covered, and for random longer and overlapping
+ * areas.  Bytes around the destination must stay untouched.
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Build the generic versions from lib/string.c under names of their
+ * own, leaving everything else to the C library.
+ */
+#define __HAVE_ARCH_STRCPY
+#define __HAVE_ARCH_STRNCPY
+#define __HAVE_ARCH_STRCAT
+#define __HAVE_ARCH_STRNCAT
+#define __HAVE_ARCH_STRCMP
+#define __HAVE_ARCH_STRNCMP
+#define __HAVE_ARCH_STRCHR
+#define __HAVE_ARCH_STRRCHR
+#define __HAVE_ARCH_STRNLEN
+#define __HAVE_ARCH_STRDUP
+#define __HAVE_ARCH_STRSPN
+#define __HAVE_ARCH_STRPBRK
+#define __HAVE_ARCH_STRTOK
+#define __HAVE_ARCH_STRSEP
+#define __HAVE_ARCH_STRSWAB
+#define __HAVE_ARCH_BCOPY
+#define __HAVE_ARCH_MEMCMP
+#define __HAVE_ARCH_MEMSCAN
+#define __HAVE_ARCH_STRSTR
+#define __HAVE_ARCH_MEMCHR
+
+typedef unsigned long ulong;	/* from U-Boot's <linux/types.h> */
+
+#define memset	ub_memset
+#define memcpy	ub_memcpy
+#define memmove	ub_memmove
+#define strlen	ub_strlen
+#include "../lib/string.c"
+#undef memset
+#undef memcpy
+#undef memmove
+#undef strlen
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_ALIGN	16	/* more than one word on any host */
+#define MAX_SHORT	160	/* all lengths up to this one */
+#define MAX_LEN		4096
+#define GUARD		32	/* untouched bytes on either side */
+#define BUF_SIZE	(GUARD + MAX_ALIGN + 2 * MAX_LEN + GUARD)
+
+static unsigned int seed = 1;
+
+static unsigned int rnd(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+static unsigned char buf[BUF_SIZE], ref[BUF_SIZE];
+
+static void fill(void)
+{
+	int i;
+
+	for (i = 0; i < BUF_SIZE; i++)
+		buf[i] = ref[i] = rnd();
+}
+
+static int compare(const char *what, int doff, int soff, int len)
+{
+	int i;
+
+	for (i = 0; i < BUF_SIZE; i++) {
+		if (buf[i] != ref[i]) {
+			printf("%s: dest %d src %d len %d: "
+			       "byte %d is 0x%02x, expected 0x%02x\n",
+			       what, doff, soff, len, i - doff, buf[i], ref[i]);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* dest and src are offsets into the buffer; the areas may overlap */
+static int test_copy(int doff, int soff, int len)
+{
+	int i, fails = 0;
+
+	fill();
+	if (ub_memmove(buf + doff, buf + soff, len) != buf + doff) {
+		printf("memmove: wrong return value\n");
+		fails++;
+	}
+	if (doff < soff) {
+		for (i = 0; i < len; i++)
+			ref[doff + i] = ref[soff + i];
+	} else {
+		for (i = len - 1; i >= 0; i--)
+			ref[doff + i] = ref[soff + i];
+	}
+	fails += compare("memmove", doff, soff, len);
+
+	/* memcpy() copes with the forward case, see memmove() */
+	if (doff + len <= soff || soff + len <= doff || doff <= soff) {
+		fill();
+		if (ub_memcpy(buf + doff, buf + soff, len) != buf + doff) {
+			printf("memcpy: wrong return value\n");
+			fails++;
+		}
+		for (i = 0; i < len; i++)
+			ref[doff + i] = ref[soff + i];
+		fails += compare("memcpy", doff, soff, len);
+	}
+	return fails;
+}
+
+static int test_set(int doff, int len)
+{
+	int i, c = rnd() & 0xff, fails = 0;
+
+	fill();
+	if (ub_memset(buf + doff, c | 0x100, len) != buf + doff) {
+		printf("memset: wrong return value\n");
+		fails++;
+	}
+	for (i = 0; i < len; i++)
+		ref[doff + i] = c;
+	return fails + compare("memset", doff, 0, len);
+}
+
+static int test_strlen(int off, int len)
+{
+	size_t got;
+
+	fill();
+	ub_memset(buf + off, 'x', len);
+	buf[off + len] = '\0';
+	got = ub_strlen((char *)buf + off);
+	if (got == len)
+		return 0;
+	printf("strlen: offset %d len %d: got %lu\n",
+	       off, len, (unsigned long)got);
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	int d, s, len, it, iterations = 2000, fails = 0;
+
+	if (argc > 1)
+		iterations = atoi(argv[1]);
+	if (argc > 2)
+		seed = strtoul(argv[2], NULL, 0);
+	if (iterations <= 0) {
+		fprintf(stderr, "usage: %s [iterations [seed]]\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	/* every alignment pair and short length, apart and overlapping */
+	for (d = 0; d < MAX_ALIGN; d++) {
+		for (len = 0; len <= MAX_SHORT; len++) {
+			for (s = 0; s < MAX_ALIGN; s++) {
+				fails += test_copy(GUARD + d,
+						   GUARD + MAX_LEN + s, len);
+				fails += test_copy(GUARD + d + MAX_ALIGN,
+						   GUARD + s, len);
+				fails += test_copy(GUARD + d,
+						   GUARD + s + MAX_ALIGN, len);
+			}
+			fails += test_set(GUARD + d, len);
+			fails += test_strlen(GUARD + d, len);
+		}
+	}
+
+	/* longer and odd sized areas */
+	for (it = 0; it < iterations; it++) {
+		len = rnd() % (MAX_LEN + 1);
+		d = GUARD + rnd() % (MAX_ALIGN + MAX_LEN);
+		s = GUARD + rnd() % (MAX_ALIGN + MAX_LEN);
+		fails += test_copy(d, s, len);
+		fails += test_set(d, len);
+		fails += test_strlen(d, len);
+	}
+
+	printf(fails ? "FAIL\n" : "PASS\n");
+	return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}